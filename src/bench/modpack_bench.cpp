@@ -0,0 +1,638 @@
+// modpack_bench: times the pack pipeline on a synthetic mods dir.
+// Flags and the json report follow Google Benchmark (--benchmark_filter, --benchmark_min_time,
+// --benchmark_out, --benchmark_format=json), so its compare.py can diff two runs between releases.
+// The synthetic dir is shaped by --mods, --geode_median, --geode_spread, --config_files, --config_size,
+// --save_files, --save_size, --settings_keys and --seed. cpu_time is process cpu time, all threads included.
+
+#include <bench/synthetic.hpp>
+#include <core/create.hpp>
+#include <core/downloads.hpp>
+#include <core/install.hpp>
+#include <xxhash.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <regex>
+
+namespace {
+
+    using namespace modpack;
+
+    class state
+    {
+    public:
+        // iterating the state runs the timed loop, like benchmark::State
+        struct iterator
+        {
+            state* owner;
+            std::size_t left;
+
+            bool operator!=(const iterator&) const
+            {
+                if (left) return true;
+                owner->stop();
+                return false;
+            }
+            void operator++() { left--; }
+            int operator*() const { return 0; }
+        };
+
+        explicit state(std::size_t iterations) : iterations_(iterations) {}
+
+        iterator begin()
+        {
+            start();
+            return { this, iterations_ };
+        }
+        iterator end() { return { this, 0 }; }
+
+        // setup inside the loop stays out of the measurement
+        void pause_timing() { stop(); }
+        void resume_timing() { start(); }
+
+        void set_bytes_processed(std::uint64_t bytes) { bytes_ = bytes; }
+        void set_label(std::string label) { label_ = std::move(label); }
+        double& counter(const std::string& name) { return counters_[name]; }
+
+        std::size_t iterations() const { return iterations_; }
+        double real_seconds() const { return real_; }
+        double cpu_seconds() const { return cpu_; }
+        std::uint64_t bytes() const { return bytes_; }
+        const std::string& label() const { return label_; }
+        const std::map<std::string, double>& counters() const { return counters_; }
+
+    private:
+        void start()
+        {
+            real_start_ = std::chrono::steady_clock::now();
+            cpu_start_ = std::clock();
+        }
+
+        void stop()
+        {
+            real_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - real_start_).count();
+            cpu_ += static_cast<double>(std::clock() - cpu_start_) / CLOCKS_PER_SEC;
+        }
+
+        std::size_t iterations_;
+        std::chrono::steady_clock::time_point real_start_;
+        std::clock_t cpu_start_ = 0;
+        double real_ = 0, cpu_ = 0;
+        std::uint64_t bytes_ = 0;
+        std::string label_;
+        std::map<std::string, double> counters_;
+    };
+
+    struct benchmark
+    {
+        std::string name;
+        std::function<void(state&)> run;
+    };
+
+    struct settings
+    {
+        std::string filter = ".*";
+        double min_time = 0.5;
+        std::string out, format = "console";
+        std::filesystem::path work;
+        bench::synthetic_options synthetic;
+    };
+
+    std::uint64_t total_size(const std::vector<miniz_cpp::zip_info>& files)
+    {
+        std::uint64_t size = 0;
+        for (const auto& info : files) size += info.file_size;
+        return size;
+    }
+
+    // keeps the result of a timed call alive so the call can't be optimized away, like benchmark::DoNotOptimize
+    template <class T>
+    void do_not_optimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static const void* volatile escape;
+        escape = &value;
+#endif
+    }
+
+    void clear_path(const std::filesystem::path& path)
+    {
+        std::error_code err;
+        std::filesystem::remove_all(path, err);
+    }
+
+    // the file hash loadit used before xxh64, kept to compare against
+    std::uint32_t fnv1a_hash(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return 0;
+
+        std::uint32_t hash = 2166136261u;
+        char c;
+        while (file.get(c))
+        {
+            hash ^= static_cast<std::uint8_t>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    std::vector<benchmark> register_benchmarks(const std::filesystem::path& work, const bench::synthetic_pack& source)
+    {
+        std::vector<benchmark> out;
+        auto pack_path = work / "bench.geode_modpack";
+        auto threads = std::max(1u, std::thread::hardware_concurrency());
+
+        std::vector<std::size_t> thread_counts = { 1 };
+        if (threads > 1) thread_counts.push_back(threads);
+
+        for (auto count : thread_counts)
+        {
+            out.push_back({ "pack_create/threads:" + std::to_string(count), [=, &source](state& state) {
+                auto path = work / "create.geode_modpack";
+                for ([[maybe_unused]] auto _ : state) write_pack(path, source.list, source.files, {}, count);
+                state.set_bytes_processed(source.bytes * state.iterations());
+                auto packed = std::filesystem::file_size(path);
+                state.counter("ratio") = source.bytes ? static_cast<double>(packed) / static_cast<double>(source.bytes) : 0;
+                clear_path(path);
+            } });
+        }
+
+        out.push_back({ "pack_load_metadata", [=](state& state) {
+            std::size_t files = 0;
+            for ([[maybe_unused]] auto _ : state) files = pack::open(pack_path).files().size();
+            state.counter("files") = static_cast<double>(files);
+        } });
+
+        for (auto count : thread_counts)
+        {
+            out.push_back({ "pack_extract_all/threads:" + std::to_string(count), [=](state& state) {
+                auto dir = work / "extract";
+                miniz_cpp::zip_file zip;
+                zip.load_file(pack_path.string());
+                auto jobs = miniz_cpp::route_entries(zip.infolist(), { { "", dir } });
+                for ([[maybe_unused]] auto _ : state)
+                {
+                    state.pause_timing();
+                    clear_path(dir);
+                    state.resume_timing();
+                    miniz_cpp::extract_entries(zip, jobs, nullptr, count);
+                }
+                state.set_bytes_processed(total_size(zip.infolist()) * state.iterations());
+                clear_path(dir);
+            } });
+        }
+
+        // cold installs into an empty root, warm ones find every file unchanged through the cache
+        for (auto warm : { false, true })
+        {
+            out.push_back({ std::string("install_root/") + (warm ? "warm" : "cold"), [=](state& state) {
+                auto root = work / "root";
+                auto routes = routes_for(root / "mods", root / "config", root / "saves");
+                auto installed = pack::open(pack_path);
+                auto cache = miniz_cpp::extract_cache::load({});
+                install_result result;
+                clear_path(root);
+                if (warm) apply(plan_install(installed, routes, nullptr, work), { .store = nullptr, .cache = cache.get() });
+                for ([[maybe_unused]] auto _ : state)
+                {
+                    if (!warm)
+                    {
+                        state.pause_timing();
+                        clear_path(root);
+                        cache = miniz_cpp::extract_cache::load({});
+                        state.resume_timing();
+                    }
+                    result = apply(plan_install(installed, routes, nullptr, work), { .store = nullptr, .cache = cache.get() });
+                }
+                state.set_bytes_processed(total_size(installed.files()) * state.iterations());
+                state.counter("extracted") = static_cast<double>(result.extracted);
+                state.counter("unchanged") = static_cast<double>(result.unchanged);
+                clear_path(root);
+            } });
+        }
+
+        // a delta of the bench pack that references every package by blob, like create --use-store. the base
+        // embeds them, so the install links them from the store and must not remove them as dropped base files
+        out.push_back({ "install_root/store_delta", [=, &source](state& state) {
+            auto root = work / "root";
+            auto routes = routes_for(root / "mods", root / "config", root / "saves");
+            auto store = modpack::store(work / "store");
+            auto cache = miniz_cpp::extract_cache::load({});
+            auto list = source.list;
+            auto files = source.files;
+            for (auto& [id, data] : list["entries"].items())
+            {
+                auto package = data["package"].as_string();
+                data["blob"] = store.put(source.mods / package);
+                files.erase(std::remove_if(files.begin(), files.end(), [&](const auto& file) { return file.first == "mods/" + package; }), files.end());
+            }
+            make_delta(list, files, pack::open(pack_path), *cache);
+            auto delta_path = work / "delta.geode_modpack";
+            write_pack(delta_path, list, files);
+            auto delta = pack::open(delta_path);
+
+            install_result result;
+            for ([[maybe_unused]] auto _ : state)
+            {
+                state.pause_timing();
+                clear_path(root);
+                cache = miniz_cpp::extract_cache::load({});
+                state.resume_timing();
+                result = apply(plan_install(delta, routes, &store, work), { .store = &store, .cache = cache.get() });
+            }
+            for (const auto& [id, data] : source.list["entries"].items())
+            {
+                if (!std::filesystem::exists(root / "mods" / data["package"].as_string())) throw std::runtime_error("store delta install lost " + id);
+            }
+            state.counter("linked") = static_cast<double>(result.linked);
+            state.counter("removed") = static_cast<double>(result.removed);
+            clear_path(root);
+            clear_path(delta_path);
+            clear_path(work / "store");
+        } });
+
+        // routing of entry names on install, with names that try to land outside of their dir mixed in.
+        // fails when one of those gets a destination
+        out.push_back({ "route_entries/hostile", [=](state& state) {
+            auto root = work / "root";
+            auto routes = routes_for(root / "mods", root / "config", root / "saves");
+            std::vector<std::string> hostile = { "mods/../x.dll", "mods//Windows/System32/x.dll", "config//etc/passwd", "saves/a/../../x" };
+#ifdef _WIN32
+            // drive names are plain dir names elsewhere
+            hostile.insert(hostile.end(), { "mods/C:/x.dll", "mods/C:x.dll" });
+#endif
+            std::vector<miniz_cpp::zip_info> entries;
+            for (const auto& name : hostile)
+            {
+                entries.emplace_back();
+                entries.back().filename = name;
+            }
+            for (std::size_t i = 0; i < 1000; i++)
+            {
+                entries.emplace_back();
+                entries.back().filename = "config/bench.mod-" + std::to_string(i) + "/settings.json";
+            }
+
+            std::vector<std::string> unsafe;
+            std::size_t routed = 0;
+            for ([[maybe_unused]] auto _ : state)
+            {
+                unsafe.clear();
+                routed = miniz_cpp::route_entries(entries, routes, nullptr, &unsafe).size();
+            }
+            for (const auto& name : hostile)
+            {
+                if (std::find(unsafe.begin(), unsafe.end(), name) == unsafe.end()) throw std::runtime_error(name + " was routed, it lands outside of its dir");
+            }
+            state.counter("routed") = static_cast<double>(routed);
+            state.counter("unsafe") = static_cast<double>(unsafe.size());
+        } });
+
+        // the install download window with a local stand-in for the mods api: requests complete in the
+        // order they were made, a third of them fail once and one never succeeds. fails when more than
+        // concurrency are in flight or a download is lost
+        out.push_back({ "download_window/stand_in", [=](state& state) {
+            constexpr std::size_t concurrency = 6, mods = 1000;
+            constexpr int max_retries = 2;
+            std::size_t most_in_flight = 0, requests = 0, failed = 0;
+            for ([[maybe_unused]] auto _ : state)
+            {
+                download_window window(concurrency, max_retries);
+                std::deque<std::string> requested;
+                window.fetch = [&](const std::string& id) {
+                    requests++;
+                    most_in_flight = std::max(most_in_flight, window.in_flight());
+                    requested.push_back(id);
+                };
+                for (std::size_t i = 0; i < mods; i++) window.add("bench.mod-" + std::to_string(i));
+
+                window.pump();
+                while (!requested.empty())
+                {
+                    auto id = std::move(requested.front());
+                    requested.pop_front();
+                    auto index = std::stoul(id.substr(id.find('-') + 1));
+                    auto ok = index != 0 && (index % 3 != 0 || window.retries(id) > 0);
+                    window.complete(id, ok);
+                    window.pump();
+                }
+                if (!window.idle() || window.done() != mods) throw std::runtime_error("download window lost a download");
+                failed = window.failed();
+            }
+            if (most_in_flight > concurrency) throw std::runtime_error("download window had " + std::to_string(most_in_flight) + " in flight");
+            if (failed != 1) throw std::runtime_error("download window failed " + std::to_string(failed) + " downloads, expected 1");
+            state.counter("requests") = static_cast<double>(requests) / static_cast<double>(state.iterations());
+        } });
+
+        out.push_back({ "pack_verify_crc", [=](state& state) {
+            miniz_cpp::zip_file zip;
+            zip.load_file(pack_path.string());
+            auto files = zip.infolist();
+            for ([[maybe_unused]] auto _ : state)
+            {
+                for (const auto& info : files) zip.read(info);
+            }
+            state.set_bytes_processed(total_size(files) * state.iterations());
+        } });
+
+        // kernels over one buffer, big enough to get past caches like package files do
+        auto buffer = std::make_shared<std::string>();
+        {
+            std::mt19937_64 random(7);
+            *buffer = bench::detail::random_bytes(random, 16 << 20);
+        }
+
+        for (int variant = 0; variant < MZ_CRC32_VARIANT_COUNT; variant++)
+        {
+            auto kind = static_cast<mz_crc32_variant>(variant);
+            if (!mz_crc32_supported(kind)) continue;
+            out.push_back({ std::string("crc32/") + mz_crc32_name(kind), [=](state& state) {
+                for ([[maybe_unused]] auto _ : state) do_not_optimize(mz_crc32_with(kind, MZ_CRC32_INIT, reinterpret_cast<const unsigned char*>(buffer->data()), buffer->size()));
+                state.set_bytes_processed(buffer->size() * state.iterations());
+            } });
+        }
+
+        out.push_back({ "hash/sha256", [=](state& state) {
+            for ([[maybe_unused]] auto _ : state) do_not_optimize(sha256::hash(buffer->data(), buffer->size()));
+            state.set_bytes_processed(buffer->size() * state.iterations());
+        } });
+
+        out.push_back({ "hash/xxh64", [=](state& state) {
+            for ([[maybe_unused]] auto _ : state) do_not_optimize(xxhash::hash(buffer->data(), buffer->size()));
+            state.set_bytes_processed(buffer->size() * state.iterations());
+        } });
+
+        // whole files hashed the way loadit does, against the byte at a time fnv1a it used before xxh64.
+        // the input is written on first use, so a filter that skips these doesn't write a gigabyte
+        for (std::uint64_t size : { std::uint64_t(1) << 20, std::uint64_t(100) << 20, std::uint64_t(1) << 30 })
+        {
+            auto suffix = "/" + std::to_string(size >> 20) + "MiB";
+            auto input = std::make_shared<std::filesystem::path>();
+            auto prepare = [=] {
+                if (!input->empty()) return *input;
+                auto path = work / "hash_input" / ("input" + suffix.substr(1) + ".bin");
+                std::filesystem::create_directories(path.parent_path());
+                std::ofstream file(path, std::ios::binary | std::ios::trunc);
+                std::mt19937_64 random(13);
+                for (std::uint64_t written = 0; written < size; written += buffer->size())
+                {
+                    auto chunk = bench::detail::random_bytes(random, static_cast<std::size_t>(std::min<std::uint64_t>(buffer->size(), size - written)));
+                    file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                }
+                if (!file.flush()) throw std::runtime_error("couldn't write " + path.string());
+                return *input = path;
+            };
+
+            out.push_back({ "hash_file/fnv1a" + suffix, [=](state& state) {
+                auto path = prepare();
+                for ([[maybe_unused]] auto _ : state) do_not_optimize(fnv1a_hash(path));
+                state.set_bytes_processed(size * state.iterations());
+            } });
+
+            out.push_back({ "hash_file/xxh64" + suffix, [=](state& state) {
+                auto path = prepare();
+                for ([[maybe_unused]] auto _ : state) do_not_optimize(xxhash::hash_file(path));
+                state.set_bytes_processed(size * state.iterations());
+            } });
+        }
+
+        // deflate of config-like text, the content packs actually compress
+        auto text = std::make_shared<std::string>();
+        {
+            std::mt19937_64 random(11);
+            while (text->size() < (4 << 20)) *text += bench::detail::random_json(random, 64 * 1024);
+        }
+
+        for (int variant = 0; variant < TDEFL_MATCH_VARIANT_COUNT; variant++)
+        {
+            auto kind = static_cast<tdefl_match_variant>(variant);
+            if (!tdefl_match_supported(kind)) continue;
+            out.push_back({ std::string("deflate/") + tdefl_match_name(kind), [=](state& state) {
+                auto compressor = std::make_unique<tdefl_compressor>();
+                std::vector<mz_uint8> output(text->size() + text->size() / 8 + 1024);
+                std::size_t packed = 0;
+                for ([[maybe_unused]] auto _ : state)
+                {
+                    tdefl_init(compressor.get(), nullptr, nullptr, static_cast<int>(tdefl_create_comp_flags_from_zip_params(MZ_DEFAULT_LEVEL, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY)));
+                    tdefl_set_match_variant(compressor.get(), kind);
+                    std::size_t in_size = text->size(), out_size = output.size();
+                    tdefl_compress(compressor.get(), text->data(), &in_size, output.data(), &out_size, TDEFL_FINISH);
+                    packed = out_size;
+                }
+                state.set_bytes_processed(text->size() * state.iterations());
+                state.counter("ratio") = static_cast<double>(packed) / static_cast<double>(text->size());
+            } });
+        }
+
+        return out;
+    }
+
+    struct run
+    {
+        std::string name;
+        state result;
+    };
+
+    // grows the iteration count until a run takes min_time, like the library does
+    run measure(const benchmark& bench, double min_time)
+    {
+        std::size_t iterations = 1;
+        while (true)
+        {
+            // spans the pipeline records would otherwise pile up across runs
+            perf::session::get().reset(bench.name);
+            state state(iterations);
+            bench.run(state);
+            if (state.real_seconds() >= min_time || iterations >= 1000000000) return { bench.name, state };
+
+            auto multiplier = state.real_seconds() > 0 ? std::min(10.0, std::max(1.4, min_time * 1.4 / state.real_seconds())) : 10.0;
+            iterations = std::max(iterations + 1, static_cast<std::size_t>(static_cast<double>(iterations) * multiplier));
+        }
+    }
+
+    std::pair<double, const char*> in_unit(double seconds)
+    {
+        if (seconds >= 1) return { seconds, "s" };
+        if (seconds >= 1e-3) return { seconds * 1e3, "ms" };
+        if (seconds >= 1e-6) return { seconds * 1e6, "us" };
+        return { seconds * 1e9, "ns" };
+    }
+
+    json report(const std::vector<run>& runs, const settings& settings, const char* executable)
+    {
+        auto out = json::object();
+        auto& context = out["context"];
+
+        char date[64];
+        auto now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+        context["date"] = date;
+        context["executable"] = executable;
+        context["num_cpus"] = std::thread::hardware_concurrency();
+#ifdef NDEBUG
+        context["library_build_type"] = "release";
+#else
+        context["library_build_type"] = "debug";
+#endif
+        context["crc32_active"] = mz_crc32_name(mz_crc32_active());
+        context["match_active"] = tdefl_match_name(tdefl_match_active());
+        context["synthetic"] = settings.synthetic.to_json();
+
+        auto& benchmarks = out["benchmarks"];
+        benchmarks = json::array();
+        for (std::size_t i = 0; i < runs.size(); i++)
+        {
+            const auto& [name, result] = runs[i];
+            auto iterations = static_cast<double>(result.iterations());
+            auto entry = json::object();
+            entry["name"] = name;
+            entry["family_index"] = i;
+            entry["per_family_instance_index"] = 0;
+            entry["run_name"] = name;
+            entry["run_type"] = "iteration";
+            entry["repetitions"] = 1;
+            entry["repetition_index"] = 0;
+            entry["threads"] = 1;
+            entry["iterations"] = result.iterations();
+            entry["real_time"] = result.real_seconds() / iterations * 1e6;
+            entry["cpu_time"] = result.cpu_seconds() / iterations * 1e6;
+            entry["time_unit"] = "us";
+            if (result.bytes()) entry["bytes_per_second"] = static_cast<double>(result.bytes()) / result.real_seconds();
+            for (const auto& [counter, value] : result.counters()) entry[counter] = value;
+            if (!result.label().empty()) entry["label"] = result.label();
+            benchmarks.push_back(entry);
+        }
+        return out;
+    }
+
+    void print_console(const run& run)
+    {
+        const auto& result = run.result;
+        auto iterations = static_cast<double>(result.iterations());
+        auto [real, real_unit] = in_unit(result.real_seconds() / iterations);
+        auto [cpu, cpu_unit] = in_unit(result.cpu_seconds() / iterations);
+
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-32s %10.3f %-2s %10.3f %-2s %10zu", run.name.c_str(), real, real_unit, cpu, cpu_unit, result.iterations());
+        std::cout << line;
+        if (result.bytes())
+        {
+            std::snprintf(line, sizeof(line), " %9.1f MiB/s", static_cast<double>(result.bytes()) / result.real_seconds() / (1 << 20));
+            std::cout << line;
+        }
+        for (const auto& [counter, value] : result.counters()) std::cout << " " << counter << "=" << value;
+        std::cout << std::endl;
+    }
+
+    bool parse_flag(const std::string& arg, const std::string& name, std::string& value)
+    {
+        auto prefix = "--" + name + "=";
+        if (arg.rfind(prefix, 0) != 0) return false;
+        value = arg.substr(prefix.size());
+        return true;
+    }
+
+    settings parse_settings(int argc, char** argv)
+    {
+        settings out;
+        auto& synthetic = out.synthetic;
+        const std::pair<const char*, std::function<void(const std::string&)>> flags[] = {
+            { "benchmark_filter", [&](const std::string& v) { out.filter = v; } },
+            { "benchmark_min_time", [&](const std::string& v) { out.min_time = std::stod(v); } },
+            { "benchmark_out", [&](const std::string& v) { out.out = v; } },
+            { "benchmark_format", [&](const std::string& v) { out.format = v; } },
+            { "work_dir", [&](const std::string& v) { out.work = v; } },
+            { "mods", [&](const std::string& v) { synthetic.mods = std::stoul(v); } },
+            { "geode_median", [&](const std::string& v) { synthetic.geode_median = std::stoull(v); } },
+            { "geode_spread", [&](const std::string& v) { synthetic.geode_spread = std::stod(v); } },
+            { "config_files", [&](const std::string& v) { synthetic.config_files = std::stoul(v); } },
+            { "config_size", [&](const std::string& v) { synthetic.config_size = std::stoul(v); } },
+            { "save_files", [&](const std::string& v) { synthetic.save_files = std::stoul(v); } },
+            { "save_size", [&](const std::string& v) { synthetic.save_size = std::stoul(v); } },
+            { "settings_keys", [&](const std::string& v) { synthetic.settings_keys = std::stoul(v); } },
+            { "seed", [&](const std::string& v) { synthetic.seed = std::stoull(v); } },
+        };
+
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i], value;
+            auto known = false;
+            for (const auto& [name, apply] : flags)
+            {
+                if (!parse_flag(arg, name, value)) continue;
+                apply(value);
+                known = true;
+                break;
+            }
+            if (known) continue;
+
+            std::cerr << "unknown flag " << arg << "\nflags:";
+            for (const auto& flag : flags) std::cerr << " --" << flag.first << "=";
+            std::cerr << "\n";
+            std::exit(2);
+        }
+        return out;
+    }
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        auto settings = parse_settings(argc, argv);
+        auto own_work = settings.work.empty();
+        auto work = own_work ? std::filesystem::temp_directory_path() / ("modpack_bench_" + std::to_string(std::time(nullptr))) : settings.work;
+        clear_path(work / "synthetic");
+
+        std::cerr << "generating synthetic mods in " << work.string() << "..." << std::endl;
+        auto source = bench::generate(work / "synthetic", settings.synthetic);
+        write_pack(work / "bench.geode_modpack", source.list, source.files);
+
+#ifndef NDEBUG
+        std::cerr << "***WARNING*** modpack_bench was built without optimizations, timings will be off (-DCMAKE_BUILD_TYPE=Release)" << std::endl;
+#endif
+
+        std::regex filter(settings.filter);
+        std::vector<run> runs;
+        auto console = settings.format == "console";
+        if (console)
+        {
+            std::printf("%-32s %13s %13s %10s\n%s\n", "Benchmark", "Time", "CPU", "Iterations", std::string(72, '-').c_str());
+        }
+        for (const auto& bench : register_benchmarks(work, source))
+        {
+            if (!std::regex_search(bench.name, filter)) continue;
+            runs.push_back(measure(bench, settings.min_time));
+            if (console) print_console(runs.back());
+        }
+
+        auto result = report(runs, settings, argv[0]);
+        if (!console) std::cout << result.dump(2) << std::endl;
+        if (!settings.out.empty())
+        {
+            std::ofstream file(settings.out, std::ios::binary | std::ios::trunc);
+            file << result.dump(2) << "\n";
+            if (!file.flush()) throw std::runtime_error("couldn't write " + settings.out);
+        }
+
+        if (own_work) clear_path(work);
+        else
+        {
+            clear_path(work / "synthetic");
+            clear_path(work / "hash_input");
+        }
+        return 0;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "modpack_bench: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+// Synthetic mods dirs for benchmarks: packages, config and saves laid out like a geode dir,
+// plus the list and file list a pack of them is written from. Everything derives from the seed,
+// so the same options give the same bytes on every machine.
+
+#include <core/pack.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace modpack::bench {
+
+    struct synthetic_options
+    {
+        std::size_t mods = 40;
+        std::uint64_t geode_median = 512 * 1024;   // package sizes are log-normal around the median,
+        double geode_spread = 1.0;                 // spread is sigma of the underlying normal, 0 makes them all equal
+        std::size_t config_files = 4;              // per mod, json
+        std::size_t config_size = 2 * 1024;
+        std::size_t save_files = 1;                // per mod, binary-ish
+        std::size_t save_size = 16 * 1024;
+        std::size_t settings_keys = 16;            // per list entry
+        std::uint64_t seed = 1;
+
+        json to_json() const
+        {
+            auto out = json::object();
+            out["mods"] = mods;
+            out["geode_median"] = geode_median;
+            out["geode_spread"] = geode_spread;
+            out["config_files"] = config_files;
+            out["config_size"] = config_size;
+            out["save_files"] = save_files;
+            out["save_size"] = save_size;
+            out["settings_keys"] = settings_keys;
+            out["seed"] = seed;
+            return out;
+        }
+    };
+
+    struct synthetic_pack
+    {
+        std::filesystem::path mods, config, saves;
+        json list;
+        file_list files;
+        std::uint64_t bytes = 0;
+    };
+
+    namespace detail {
+
+        inline void write_file(const std::filesystem::path& path, const std::string& data)
+        {
+            std::filesystem::create_directories(path.parent_path());
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!file.flush()) throw std::runtime_error("couldn't write " + path.string());
+        }
+
+        // incompressible, like the already deflated contents of a .geode
+        inline std::string random_bytes(std::mt19937_64& random, std::size_t size)
+        {
+            std::string out(size, '\0');
+            for (std::size_t i = 0; i < size; i += 8)
+            {
+                auto word = random();
+                std::memcpy(&out[i], &word, std::min<std::size_t>(8, size - i));
+            }
+            return out;
+        }
+
+        // a json object of short keys and values, grown until it reaches size
+        inline std::string random_json(std::mt19937_64& random, std::size_t size)
+        {
+            static const char* words[] = { "enabled", "speed", "color", "offset", "scale", "mode", "label", "limit", "true", "false" };
+            auto out = json::object();
+            std::size_t length = 2;
+            for (std::size_t i = 0; length < size; i++)
+            {
+                auto key = "key_" + std::to_string(i);
+                auto value = random() % 3 == 0 ? json(static_cast<double>(random() % 100000) / 100)
+                    : json(std::string(words[random() % 10]) + "_" + std::to_string(random() % 1000));
+                length += key.size() + value.dump().size() + 4;
+                out[key] = value;
+            }
+            return out.dump(4);
+        }
+
+    } // namespace detail
+
+    // writes mods/<id>.geode, config/<id>/*.json and saves/<id>/*.dat under dir
+    inline synthetic_pack generate(const std::filesystem::path& dir, const synthetic_options& options)
+    {
+        std::mt19937_64 random(options.seed);
+        std::lognormal_distribution<double> sizes(std::log(static_cast<double>(std::max<std::uint64_t>(options.geode_median, 1))), options.geode_spread);
+
+        synthetic_pack out;
+        out.mods = dir / "mods";
+        out.config = dir / "config";
+        out.saves = dir / "saves";
+        out.list["name"] = "synthetic";
+        out.list["creator"] = "modpack_bench";
+        out.list["entries"] = json::object();
+
+        for (std::size_t mod = 0; mod < options.mods; mod++)
+        {
+            char id[32];
+            std::snprintf(id, sizeof(id), "bench.mod-%04zu", mod);
+
+            auto size = options.geode_spread > 0 ? static_cast<std::uint64_t>(sizes(random)) : options.geode_median;
+            size = std::clamp<std::uint64_t>(size, 1024, 256ull << 20);
+            auto package = std::string(id) + ".geode";
+            auto bytes = "PK\x03\x04" + detail::random_bytes(random, static_cast<std::size_t>(size) - 4);
+            detail::write_file(out.mods / package, bytes);
+            out.files.emplace_back("mods/" + package, out.mods / package);
+            out.bytes += bytes.size();
+
+            for (std::size_t i = 0; i < options.config_files; i++)
+            {
+                auto name = std::string(id) + "/config_" + std::to_string(i) + ".json";
+                auto data = detail::random_json(random, options.config_size);
+                detail::write_file(out.config / name, data);
+                out.files.emplace_back("config/" + name, out.config / name);
+                out.bytes += data.size();
+            }
+
+            for (std::size_t i = 0; i < options.save_files; i++)
+            {
+                // half repeating records, half noise, roughly what game saves compress like
+                auto name = std::string(id) + "/save_" + std::to_string(i) + ".dat";
+                auto data = detail::random_bytes(random, options.save_size / 2);
+                while (data.size() < options.save_size) data += "record:" + std::to_string(data.size() % 977) + ";";
+                data.resize(options.save_size);
+                detail::write_file(out.saves / name, data);
+                out.files.emplace_back("saves/" + name, out.saves / name);
+                out.bytes += data.size();
+            }
+
+            auto& entry = out.list["entries"][id];
+            entry["package"] = package;
+            if (options.settings_keys)
+            {
+                auto& settings = entry["settings"];
+                settings = json::object();
+                for (std::size_t i = 0; i < options.settings_keys; i++)
+                {
+                    auto key = "setting_" + std::to_string(i);
+                    switch (random() % 3)
+                    {
+                    case 0: settings[key] = random() % 2 == 0; break;
+                    case 1: settings[key] = static_cast<std::int64_t>(random() % 1000000); break;
+                    default: settings[key] = "value_" + std::to_string(random() % 100000); break;
+                    }
+                }
+            }
+        }
+
+        return out;
+    }
+
+} // namespace modpack::bench
@@ -0,0 +1,415 @@
+// modpack: builds, checks and installs packs outside of the game, on top of the core pack logic.
+// Runs anywhere the core builds (build boxes, server side pipelines), see usage() for the commands.
+
+#include <core/create.hpp>
+#include <core/install.hpp>
+
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <set>
+
+namespace {
+
+    // the running create, cancelled on ctrl+c so it leaves its checkpoint behind
+    std::atomic<modpack::create_job*> interrupted_job = nullptr;
+
+    void usage()
+    {
+        std::cerr <<
+            "usage:\n"
+            "  modpack create <out.geode_modpack|out.geode_modlist> [--name <name>] [--creator <name>]\n"
+            "                 [--list <modlist>] [--mods <dir>] [--config <dir>] [--saves <dir>]\n"
+            "                 [--about <md>] [--logo <png>] [--delta-of <pack>] [--store <dir>] [--use-store]\n"
+            "                 [--cache <file>] [--threads <n>] [--checkpoint <dir>]\n"
+            "  modpack inspect <pack> [--json]\n"
+            "  modpack extract <pack> <dir> [--threads <n>]\n"
+            "  modpack verify <pack> [--store <dir>] [--packs <dir>]\n"
+            "  modpack install <pack> --root <dir> [--store <dir>] [--packs <dir>] [--cache <file>] [--threads <n>]\n"
+            "\n"
+            "create takes packages (<mod id>.geode) from --mods, and config/saves of those mods from\n"
+            "--config/<mod id> and --saves/<mod id>. install puts files in <root>/mods, <root>/config and\n"
+            "<root>/saves. delta bases are looked for in --packs, the pack's own dir by default.\n"
+            "create keeps compressed files in --checkpoint when interrupted (ctrl+c), running it again\n"
+            "with the same checkpoint compresses only what's left.\n"
+            "every command takes --perf <report.json> to write phase and per file timings, and\n"
+            "--trace <trace.json> to record a timeline of them for ui.perfetto.dev or chrome://tracing.\n";
+    }
+
+    struct arguments
+    {
+        std::vector<std::string> positional;
+        std::map<std::string, std::string> options;
+        std::set<std::string> flags;
+
+        bool has(const std::string& name) const { return flags.count(name) || options.count(name); }
+
+        std::string get(const std::string& name, const std::string& fallback = "") const
+        {
+            auto found = options.find(name);
+            return found == options.end() ? fallback : found->second;
+        }
+
+        std::size_t threads() const { return static_cast<std::size_t>(std::stoul(get("--threads", "0"))); }
+    };
+
+    arguments parse_arguments(int argc, char** argv, int first)
+    {
+        static const std::set<std::string> flags = { "--json", "--use-store" };
+
+        arguments out;
+        for (int i = first; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) out.positional.push_back(arg);
+            else if (flags.count(arg)) out.flags.insert(arg);
+            else if (i + 1 < argc) out.options[arg] = argv[++i];
+            else throw std::runtime_error(arg + " needs a value");
+        }
+        return out;
+    }
+
+    std::string human_size(std::uint64_t bytes)
+    {
+        const char* units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+        auto value = static_cast<double>(bytes);
+        auto unit = 0;
+        while (value >= 1024 && unit < 4)
+        {
+            value /= 1024;
+            unit++;
+        }
+        char out[32];
+        std::snprintf(out, sizeof(out), unit ? "%.1f %s" : "%.0f %s", value, units[unit]);
+        return out;
+    }
+
+    // files of dir/<id>/ as they go into a pack under prefix/<id>/
+    void add_mod_files(modpack::file_list& files, const std::filesystem::path& dir, const std::string& id, const std::string& prefix)
+    {
+        std::error_code err;
+        auto root = dir / id;
+        if (!std::filesystem::is_directory(root, err)) return;
+
+        std::vector<std::filesystem::path> found;
+        for (const auto& file : std::filesystem::recursive_directory_iterator(root, err))
+        {
+            if (file.is_regular_file()) found.push_back(file.path());
+        }
+        std::sort(found.begin(), found.end());
+        for (const auto& path : found)
+        {
+            files.emplace_back(prefix + id + "/" + path.lexically_relative(root).generic_string(), path);
+        }
+    }
+
+    int create(const arguments& args)
+    {
+        if (args.positional.size() != 1) return usage(), 2;
+        auto out = std::filesystem::path(args.positional[0]);
+
+        auto list = args.has("--list") ? modpack::pack::read_list(args.get("--list")) : modpack::json::object();
+        if (args.has("--name")) list["name"] = args.get("--name");
+        if (args.has("--creator")) list["creator"] = args.get("--creator");
+        if (!list["entries"].is_object()) list["entries"] = modpack::json::object();
+
+        std::unique_ptr<modpack::store> store;
+        if (args.has("--store")) store = std::make_unique<modpack::store>(args.get("--store"));
+        if (args.has("--use-store") && !store) throw std::runtime_error("--use-store needs --store");
+
+        modpack::file_list files;
+        std::error_code err;
+        if (args.has("--mods"))
+        {
+            std::vector<std::filesystem::path> packages;
+            for (const auto& file : std::filesystem::directory_iterator(args.get("--mods")))
+            {
+                if (file.is_regular_file() && file.path().extension() == ".geode") packages.push_back(file.path());
+            }
+            std::sort(packages.begin(), packages.end());
+
+            for (const auto& package : packages)
+            {
+                auto& entry = list["entries"][package.stem().string()];
+                if (entry.is_null()) entry = modpack::json::object();
+                entry["package"] = package.filename().string();
+
+                auto hash = store ? store->put(package) : "";
+                if (!hash.empty()) entry["blob"] = hash;
+                if (hash.empty() || !args.has("--use-store")) files.emplace_back("mods/" + package.filename().string(), package);
+            }
+        }
+
+        for (const auto& [id, entry] : list["entries"].items())
+        {
+            if (args.has("--config")) add_mod_files(files, args.get("--config"), id, "config/");
+            if (args.has("--saves")) add_mod_files(files, args.get("--saves"), id, "saves/");
+        }
+        if (args.has("--about")) files.emplace_back("about.md", args.get("--about"));
+        if (args.has("--logo")) files.emplace_back("logo.png", args.get("--logo"));
+
+        if (args.has("--delta-of"))
+        {
+            auto base = modpack::pack::open(args.get("--delta-of"));
+            auto cache = miniz_cpp::extract_cache::load(args.get("--cache"));
+            if (!modpack::make_delta(list, files, base, *cache)) std::cerr << base.path().filename().string() << " is a delta itself, writing a full pack\n";
+            cache->save();
+        }
+
+        if (!modpack::is_archive(out) && !files.empty())
+        {
+            std::cerr << "modlists keep no files, " << files.size() << " files left out\n";
+            files.clear();
+        }
+
+        modpack::create_job job;
+        modpack::write_options options;
+        options.threads = args.threads();
+        options.job = &job;
+        std::unique_ptr<modpack::create_checkpoint> checkpoint;
+        if (args.has("--checkpoint"))
+        {
+            checkpoint = std::make_unique<modpack::create_checkpoint>(args.get("--checkpoint"));
+            options.checkpoint = checkpoint.get();
+        }
+
+        interrupted_job = &job;
+        std::signal(SIGINT, [](int) { if (auto job = interrupted_job.load()) job->cancel(); });
+        try
+        {
+            modpack::write_pack(out, list, files, options);
+        }
+        catch (const modpack::cancelled&)
+        {
+            interrupted_job = nullptr;
+            auto state = job.snapshot();
+            std::cerr << "cancelled after " << state.entries_done << " of " << state.entries_total << " files"
+                      << (checkpoint ? ", run again with the same --checkpoint to go on" : "") << "\n";
+            return 130;
+        }
+        interrupted_job = nullptr;
+        if (checkpoint) checkpoint->clear();
+
+        auto state = job.snapshot();
+        if (state.reused) std::cerr << state.reused << " of " << state.entries_total << " files taken from the checkpoint\n";
+        std::cout << "created " << out.string() << ": " << list["entries"].size() << " entries, " << files.size() << " files, "
+                  << human_size(std::filesystem::file_size(out)) << "\n";
+        return 0;
+    }
+
+    int inspect(const arguments& args)
+    {
+        if (args.positional.size() != 1) return usage(), 2;
+        auto pack = modpack::pack::open(args.positional[0]);
+
+        if (args.has("--json"))
+        {
+            std::cout << pack.list().dump(4) << "\n";
+            return 0;
+        }
+
+        std::cout << "name: " << pack.name() << "\n";
+        std::cout << "creator: " << pack.creator() << "\n";
+        if (pack.is_delta())
+        {
+            const auto& delta = pack.delta();
+            std::cout << "delta of: " << delta["base_name"].as_string() << " (" << delta["base"].as_string() << "), removes "
+                      << delta["removed"].size() << " files and " << delta["removed_entries"].size() << " entries\n";
+        }
+
+        std::cout << "entries: " << pack.entries().size() << "\n";
+        for (const auto& [id, data] : pack.entries().items())
+        {
+            auto entry = modpack::entry { id, data };
+            std::cout << "  " << id;
+            if (!entry.package().empty()) std::cout << "  " << entry.package();
+            if (!entry.blob().empty()) std::cout << "  blob " << entry.blob().substr(0, 12);
+            if (data.contains("settings")) std::cout << "  +settings";
+            if (data.contains("saved")) std::cout << "  +saved";
+            std::cout << "\n";
+        }
+
+        std::uint64_t size = 0, compressed = 0;
+        for (const auto& info : pack.files())
+        {
+            size += info.file_size;
+            compressed += info.compress_size;
+        }
+        std::cout << "files: " << pack.files().size() << ", " << human_size(size) << " (" << human_size(compressed) << " packed)\n";
+        for (const auto& info : pack.files())
+        {
+            char crc[9];
+            std::snprintf(crc, sizeof(crc), "%08x", info.crc);
+            std::cout << "  " << crc << "  " << human_size(info.file_size) << "  " << info.filename << "\n";
+        }
+        return 0;
+    }
+
+    int extract(const arguments& args)
+    {
+        if (args.positional.size() != 2) return usage(), 2;
+
+        miniz_cpp::zip_file zip;
+        zip.load_file(args.positional[0]);
+
+        std::vector<std::string> unsafe;
+        auto jobs = miniz_cpp::route_entries(zip.infolist(), { { "", args.positional[1] } }, nullptr, &unsafe);
+        for (const auto& name : unsafe) std::cerr << "skipping unsafe entry " << name << "\n";
+
+        auto written = miniz_cpp::extract_entries(zip, jobs, nullptr, args.threads());
+        std::cout << "extracted " << written << " files to " << args.positional[1] << "\n";
+        return 0;
+    }
+
+    int verify(const arguments& args)
+    {
+        if (args.positional.size() != 1) return usage(), 2;
+        auto pack = modpack::pack::open(args.positional[0]);
+        std::vector<std::string> problems;
+
+        // extraction checks the crc of every file
+        if (pack.archive())
+        {
+            miniz_cpp::zip_file zip;
+            zip.load_file(pack.path().string());
+            for (const auto& info : zip.infolist())
+            {
+                try
+                {
+                    zip.read(info);
+                }
+                catch (const std::exception& e)
+                {
+                    problems.push_back(info.filename + ": " + e.what());
+                }
+                bool unsafe = false;
+                miniz_cpp::route_entry(info.filename, modpack::routes_for("mods", "config", "saves"), &unsafe);
+                if (unsafe) problems.push_back(info.filename + ": lands outside of its dir on install");
+            }
+        }
+
+        std::unique_ptr<modpack::store> store;
+        if (args.has("--store")) store = std::make_unique<modpack::store>(args.get("--store"));
+
+        std::size_t unresolved = 0;
+        for (const auto& [id, data] : pack.entries().items())
+        {
+            auto entry = modpack::entry { id, data };
+            if (!entry.package().empty() && !entry.has_safe_package()) problems.push_back(id + ": unsafe package name " + entry.package());
+            if (!entry.blob().empty() && !modpack::store::valid_hash(entry.blob())) problems.push_back(id + ": bad blob hash " + entry.blob());
+            if (pack.has_file("mods/" + entry.package())) continue;
+            if (store && !entry.blob().empty() && !store->has(entry.blob())) problems.push_back(id + ": blob " + entry.blob() + " isn't in the store");
+            else if (!store || entry.blob().empty()) unresolved++;
+        }
+
+        if (pack.is_delta())
+        {
+            auto dir = args.get("--packs", pack.path().parent_path().string());
+            auto base = modpack::find_delta_base(pack.delta(), dir.empty() ? "." : dir);
+            if (base.empty()) problems.push_back("base pack " + pack.delta()["base_name"].as_string() + " wasn't found in " + dir);
+            else std::cout << "delta base: " << base.string() << "\n";
+        }
+
+        for (const auto& problem : problems) std::cout << "  " << problem << "\n";
+        std::cout << pack.path().string() << ": " << pack.files().size() << " files, " << pack.entries().size() << " entries, "
+                  << unresolved << " to download on install, " << problems.size() << " problems\n";
+        return problems.empty() ? 0 : 1;
+    }
+
+    int install(const arguments& args)
+    {
+        if (args.positional.size() != 1 || !args.has("--root")) return usage(), 2;
+        auto root = std::filesystem::path(args.get("--root"));
+        auto routes = modpack::routes_for(root / "mods", root / "config", root / "saves");
+
+        auto pack = modpack::pack::open(args.positional[0]);
+        auto packs = args.get("--packs", pack.path().parent_path().string());
+
+        std::unique_ptr<modpack::store> store;
+        if (args.has("--store")) store = std::make_unique<modpack::store>(args.get("--store"));
+
+        auto plan = modpack::plan_install(pack, routes, store.get(), packs.empty() ? "." : packs);
+        for (const auto& name : plan.unsafe) std::cerr << "skipping unsafe entry " << name << "\n";
+
+        auto cache = miniz_cpp::extract_cache::load(args.get("--cache"));
+        modpack::install_options options;
+        options.store = store.get();
+        options.cache = cache.get();
+        options.threads = args.threads();
+        auto result = modpack::apply(plan, options);
+        cache->save();
+
+        for (const auto& [path, data] : modpack::entry_data_files(plan.entries, root / "saves"))
+        {
+            std::filesystem::create_directories(path.parent_path());
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file << data;
+            if (!file.flush()) throw std::runtime_error("couldn't write " + path.string());
+        }
+
+        for (const auto& name : result.failed_links) std::cerr << "failed to link stored package " << name << "\n";
+        for (const auto& id : plan.removed_entries) std::cout << "remove mod " << id << "\n";
+        for (const auto& id : plan.unresolved) std::cout << "download mod " << id << "\n";
+        std::cout << "installed " << pack.path().filename().string() << " to " << root.string() << ": "
+                  << result.linked << " linked, " << result.extracted << " extracted, " << result.unchanged << " unchanged, "
+                  << result.removed << " removed, " << result.stored << " stored\n";
+        return result.failed_links.empty() ? 0 : 1;
+    }
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        usage();
+        return 2;
+    }
+
+    static const std::map<std::string, int (*)(const arguments&)> commands = {
+        { "create", create },
+        { "inspect", inspect },
+        { "extract", extract },
+        { "verify", verify },
+        { "install", install },
+    };
+
+    auto command = commands.find(argv[1]);
+    if (command == commands.end())
+    {
+        usage();
+        return 2;
+    }
+
+    try
+    {
+        auto args = parse_arguments(argc, argv, 2);
+        // --threads sizes the task pool too, extraction and compression run on it
+        if (args.has("--threads")) tasks::pool::configure(args.threads());
+        perf::session::get().reset(argv[1]);
+        perf::trace::name_thread("main");
+        if (args.has("--trace")) perf::trace::start();
+        auto status = command->second(args);
+        if (args.has("--trace"))
+        {
+            perf::trace::stop();
+            std::ofstream trace(args.get("--trace"), std::ios::binary | std::ios::trunc);
+            trace << perf::trace::to_json();
+            if (!trace.flush()) throw std::runtime_error("couldn't write " + args.get("--trace"));
+        }
+        if (args.has("--perf"))
+        {
+            std::ofstream report(args.get("--perf"), std::ios::binary | std::ios::trunc);
+            report << perf::session::get().to_json();
+            if (!report.flush()) throw std::runtime_error("couldn't write " + args.get("--perf"));
+            std::cerr << perf::session::get().summary();
+        }
+        return status;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "modpack " << argv[1] << ": " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,309 @@
+#pragma once
+
+// Writing packs as a job: cancellable between entries, with progress and an eta, written to a .part
+// file that only replaces the pack once complete. A checkpoint keeps entries compressed by an
+// interrupted run, so running the same creation again only compresses what it didn't get to.
+
+#include <core/pack.hpp>
+#include <xxhash.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+
+namespace modpack {
+
+    struct cancelled : std::runtime_error
+    {
+        cancelled() : std::runtime_error("cancelled") {}
+    };
+
+    // shared between the thread writing a pack and whoever watches or cancels it
+    class create_job
+    {
+    public:
+        struct state
+        {
+            std::size_t entries_done = 0, entries_total = 0, reused = 0;
+            std::uint64_t bytes_done = 0, bytes_total = 0;
+            double elapsed = 0;     // seconds
+            double eta = -1;        // seconds left, -1 until there's enough done to tell
+
+            double fraction() const { return bytes_total ? std::min(1.0, static_cast<double>(bytes_done) / static_cast<double>(bytes_total)) : 0; }
+        };
+
+        void cancel() { cancelled_ = true; }
+        bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+        // throws modpack::cancelled once cancel() was called
+        void check() const
+        {
+            if (cancelled()) throw modpack::cancelled();
+        }
+
+        void start(std::size_t entries, std::uint64_t bytes)
+        {
+            started_ = std::chrono::steady_clock::now();
+            entries_total_ = entries;
+            bytes_total_ = bytes;
+            entries_done_ = 0;
+            bytes_done_ = 0;
+            reused_ = 0;
+            bytes_reused_ = 0;
+        }
+
+        // from any thread, as entries get compressed or taken from the checkpoint
+        void advance(std::uint64_t bytes, bool reused = false)
+        {
+            bytes_done_ += bytes;
+            entries_done_++;
+            if (!reused) return;
+            reused_++;
+            bytes_reused_ += bytes;
+        }
+
+        state snapshot() const
+        {
+            // before bytes_done_, which advance() moves first, so it never reads ahead of it
+            std::uint64_t reused_bytes = bytes_reused_;
+            state out;
+            out.entries_done = entries_done_;
+            out.entries_total = entries_total_;
+            out.reused = reused_;
+            out.bytes_done = bytes_done_;
+            out.bytes_total = bytes_total_;
+            out.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_.load()).count();
+            // reused entries are done in no time, the rate comes from compressed ones alone
+            auto compressed = out.bytes_done - reused_bytes;
+            if (compressed && out.elapsed > 0.5)
+            {
+                auto left = out.bytes_total > out.bytes_done ? out.bytes_total - out.bytes_done : 0;
+                out.eta = out.elapsed * static_cast<double>(left) / static_cast<double>(compressed);
+            }
+            return out;
+        }
+
+    private:
+        std::atomic_bool cancelled_ { false };
+        std::atomic<std::chrono::steady_clock::time_point> started_ { std::chrono::steady_clock::now() };
+        std::atomic_size_t entries_done_ { 0 }, entries_total_ { 0 }, reused_ { 0 };
+        std::atomic<std::uint64_t> bytes_done_ { 0 }, bytes_total_ { 0 }, bytes_reused_ { 0 };
+    };
+
+    // deflated entries by what they were made from: name, source path, size, mtime and the policy's
+    // levels. a file per entry named by a hash of that key: "crc size deflated", the key, then the entry data
+    class create_checkpoint
+    {
+    public:
+        explicit create_checkpoint(std::filesystem::path dir) : dir_(std::move(dir)) {}
+
+        const std::filesystem::path& dir() const { return dir_; }
+
+        // empty when the source can't be looked at, such an entry is never kept
+        static std::string key(const std::string& arcname, const std::filesystem::path& source, const miniz_cpp::compression_policy& policy)
+        {
+            std::error_code err;
+            auto size = std::filesystem::file_size(source, err);
+            if (err) return "";
+            auto mtime = std::filesystem::last_write_time(source, err);
+            if (err) return "";
+            return arcname + '\x1f' + source.string() + '\x1f' + std::to_string(size) + ':' + std::to_string(mtime.time_since_epoch().count())
+                + ':' + std::to_string(policy.text_level) + ':' + std::to_string(policy.binary_level) + ':' + std::to_string(policy.compressed_level);
+        }
+
+        std::optional<miniz_cpp::compressed_entry> find(const std::string& key, const std::string& arcname) const
+        {
+            if (key.empty()) return std::nullopt;
+            std::ifstream file(path_of(key), std::ios::binary);
+            if (!file) return std::nullopt;
+
+            miniz_cpp::compressed_entry entry;
+            int deflated = 0;
+            std::string stored_key;
+            if (!(file >> entry.crc >> entry.file_size >> deflated) || file.get() != '\n') return std::nullopt;
+            // the key is kept too, a hash collision must not hand out another file's data
+            if (!std::getline(file, stored_key) || stored_key != key) return std::nullopt;
+
+            entry.arcname = arcname;
+            entry.deflated = deflated != 0;
+            entry.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            if (!entry.deflated && entry.data.size() != entry.file_size) return std::nullopt;
+            return entry;
+        }
+
+        // best effort, a checkpoint that can't be written only means compressing again next time.
+        // only deflated entries are kept, stored ones (packages) are as cheap to read again from their source
+        void store(const std::string& key, const miniz_cpp::compressed_entry& entry) const
+        {
+            if (!entry.deflated || key.empty() || key.find('\n') != std::string::npos) return;
+            std::error_code err;
+            std::filesystem::create_directories(dir_, err);
+            auto path = path_of(key);
+            auto part = std::filesystem::path(path).concat(".part");
+            std::ofstream file(part, std::ios::binary | std::ios::trunc);
+            file << entry.crc << ' ' << entry.file_size << ' ' << (entry.deflated ? 1 : 0) << '\n' << key << '\n';
+            file.write(entry.data.data(), static_cast<std::streamsize>(entry.data.size()));
+            file.close();
+            if (file.fail())
+            {
+                std::filesystem::remove(part, err);
+                return;
+            }
+            std::filesystem::rename(part, path, err);
+            if (err) std::filesystem::remove(part, err);
+        }
+
+        void clear() const
+        {
+            std::error_code err;
+            std::filesystem::remove_all(dir_, err);
+        }
+
+        // checkpoints of packs under root that weren't written to for max_age, left by creations that
+        // were given up on or packs that got renamed since. keep is never removed
+        static void prune(const std::filesystem::path& root, std::chrono::hours max_age, const std::filesystem::path& keep = {})
+        {
+            std::error_code err;
+            auto now = std::filesystem::file_time_type::clock::now();
+            std::vector<std::filesystem::path> stale;
+            for (const auto& dir : std::filesystem::directory_iterator(root, err))
+            {
+                if (dir.path() == keep) continue;
+                auto written = std::filesystem::last_write_time(dir.path(), err);
+                if (!err && now - written > max_age) stale.push_back(dir.path());
+            }
+            for (const auto& dir : stale) std::filesystem::remove_all(dir, err);
+        }
+
+    private:
+        std::filesystem::path path_of(const std::string& key) const
+        {
+            char name[24];
+            std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(xxhash::hash(key.data(), key.size())));
+            return dir_ / (std::string(name) + ".entry");
+        }
+
+        std::filesystem::path dir_;
+    };
+
+    struct write_options
+    {
+        miniz_cpp::compression_policy policy;
+        std::size_t threads = 0;                            // at once on the task pool, 0 for all of its workers
+        tasks::priority priority = tasks::priority::normal;
+        std::function<void(const std::string&)> progress;  // names as they're queued
+        create_job* job = nullptr;                          // checked before every entry
+        const create_checkpoint* checkpoint = nullptr;      // entries are looked up in and added to it
+    };
+
+    // writes a modpack of files and list, or only the list when the path isn't a .geode_modpack.
+    // files are read and compressed on the task pool, each whole, and held until written in order. the ones
+    // being compressed or waiting to be written are kept under parallel_writer::default_max_bytes of source
+    // together, a bigger file goes alone. files of a MiB or more the policy stores are copied in chunks
+    // instead. the pack is written next to path as .part and renamed over it when complete, on errors and
+    // cancellation only the .part is removed
+    inline void write_pack(const std::filesystem::path& path, const json& list, const file_list& files, const write_options& options)
+    {
+        perf::span span("create.write");
+        auto part = std::filesystem::path(path).concat(".part");
+        std::error_code err;
+
+        try
+        {
+            if (options.job)
+            {
+                std::uint64_t bytes = 0;
+                for (const auto& [_, source] : files)
+                {
+                    auto size = std::filesystem::file_size(source, err);
+                    if (!err) bytes += size;
+                }
+                options.job->start(files.size(), bytes);
+                options.job->check();
+            }
+
+            if (!is_archive(path))
+            {
+                std::ofstream file(part, std::ios::binary | std::ios::trunc);
+                file << list.dump();
+                if (!file.flush()) throw std::runtime_error("couldn't write " + path.string());
+            }
+            else
+            {
+                // big files that are stored anyway (packages, media) are copied in chunks, not read whole
+                constexpr std::uint64_t stream_from = 1 << 20;
+
+                miniz_cpp::zip_file zip;
+                zip.policy = options.policy;
+                zip.create_file(part.string());
+                {
+                    miniz_cpp::parallel_writer writer(zip, options.threads, options.priority);
+                    for (const auto& [name, source] : files)
+                    {
+                        if (options.job) options.job->check();
+                        if (options.progress) options.progress(name);
+                        auto size = std::filesystem::file_size(source, err);
+                        if (!err && size >= stream_from && options.policy.level_for_file(name, source) == MZ_NO_COMPRESSION)
+                        {
+                            writer.add_stored(name, source, [&options](std::uint64_t written) {
+                                if (options.job) options.job->advance(written);
+                            });
+                            continue;
+                        }
+                        writer.add_entry([name = name, source = source, &options](const miniz_cpp::compression_policy& policy) {
+                            if (options.job) options.job->check();
+                            auto key = options.checkpoint ? create_checkpoint::key(name, source, policy) : std::string();
+                            if (options.checkpoint)
+                            {
+                                if (auto kept = options.checkpoint->find(key, name))
+                                {
+                                    perf::span span("compress.reused", name);
+                                    span.bytes(kept->file_size, kept->data.size());
+                                    if (options.job) options.job->advance(kept->file_size, true);
+                                    return *kept;
+                                }
+                            }
+
+                            perf::span span("compress", name);
+                            auto bytes = read_text(source);
+                            auto level = policy.level_for(name, bytes);
+                            auto entry = miniz_cpp::zip_file::compress(name, std::move(bytes), level);
+                            span.bytes(entry.file_size, entry.data.size());
+                            if (options.checkpoint) options.checkpoint->store(key, entry);
+                            if (options.job) options.job->advance(entry.file_size);
+                            return entry;
+                        }, err ? 0 : size);
+                    }
+                    writer.finish();
+                }
+                if (options.job) options.job->check();
+                zip.writestr(list_entry, list.dump());
+                zip.save(part.string());
+                // saving reopens the file for reading, windows won't rename it while it's open
+                zip.reset();
+            }
+
+            std::filesystem::rename(part, path);
+        }
+        catch (...)
+        {
+            std::filesystem::remove(part, err);
+            throw;
+        }
+
+        auto size = std::filesystem::file_size(path, err);
+        if (!err) span.bytes_out(size);
+    }
+
+    inline void write_pack(const std::filesystem::path& path, const json& list, const file_list& files,
+        const miniz_cpp::compression_policy& policy = {}, std::size_t threads = 0,
+        const std::function<void(const std::string&)>& progress = nullptr)
+    {
+        write_options options;
+        options.policy = policy;
+        options.threads = threads;
+        options.progress = progress;
+        write_pack(path, list, files, options);
+    }
+
+} // namespace modpack
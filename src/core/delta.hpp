@@ -0,0 +1,96 @@
+#pragma once
+
+// Delta packs keep only what differs from a base pack and install on top of it.
+// The list of a delta has a "delta" object: base (sha256 of the base pack file), base_name (its file name
+// when the delta was made), removed (base files the delta drops) and removed_entries (base entries it drops).
+
+#include <core/pack.hpp>
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+namespace modpack {
+
+    // file name prefixes of pack files that get installed somewhere
+    constexpr const char* routed_prefixes[] = { "mods/", "config/", "saves/" };
+
+    inline bool is_routed(const std::string& name)
+    {
+        if (name.empty() || name.back() == '/') return false;
+        return std::any_of(std::begin(routed_prefixes), std::end(routed_prefixes), [&](const char* prefix) {
+            return name.rfind(prefix, 0) == 0;
+        });
+    }
+
+    // trims list and files down to what differs from base. files whose source matches the base's copy
+    // by size and crc are dropped, the crc of sources is cached by their stamp so repeated deltas don't reread them.
+    // returns false and leaves both as they are when base is a delta itself, deltas of deltas aren't made
+    inline bool make_delta(json& list, file_list& files, const pack& base, miniz_cpp::extract_cache& cache)
+    {
+        if (base.is_delta()) return false;
+
+        std::map<std::string, const miniz_cpp::zip_info*> base_files;
+        for (const auto& info : base.files()) base_files[info.filename] = &info;
+
+        // what the delta still provides: its files and packages it references by blob, which installs link from the store
+        std::set<std::string> names;
+        for (const auto& file : files) names.insert(file.first);
+        for (const auto& [id, data] : list["entries"].items())
+        {
+            auto mod = entry { id, data };
+            if (mod.has_safe_package() && !mod.blob().empty()) names.insert("mods/" + mod.package());
+        }
+        files.erase(std::remove_if(files.begin(), files.end(), [&](const auto& file) {
+            auto found = base_files.find(file.first);
+            return found != base_files.end() && cache.unchanged(file.second, *found->second);
+        }), files.end());
+
+        auto removed = json::array();
+        for (const auto& [name, info] : base_files)
+        {
+            if (is_routed(name) && !names.count(name)) removed.push_back(name);
+        }
+
+        auto removed_entries = json::array();
+        auto& entries = list["entries"];
+        for (const auto& [id, entry] : base.entries().items())
+        {
+            if (!entries.contains(id)) removed_entries.push_back(id);
+            else if (entries[id] == entry) entries.erase(id);
+        }
+
+        auto& delta = list["delta"];
+        delta["base"] = base.hash();
+        delta["base_name"] = base.path().filename().string();
+        delta["removed"] = removed;
+        delta["removed_entries"] = removed_entries;
+        return true;
+    }
+
+    // finds the pack a delta was made of by its hash in dir, the file it was named after goes first.
+    // empty if there's none
+    inline std::filesystem::path find_delta_base(const json& delta, const std::filesystem::path& dir)
+    {
+        auto hash = delta["base"].as_string();
+        auto name = delta["base_name"].as_string();
+        if (hash.empty()) return {};
+
+        std::vector<std::filesystem::path> candidates;
+        std::error_code err;
+        for (const auto& file : std::filesystem::directory_iterator(dir, err))
+        {
+            if (is_pack_file(file.path())) candidates.push_back(file.path());
+        }
+        std::stable_partition(candidates.begin(), candidates.end(), [&](const auto& path) {
+            return path.filename().string() == name;
+        });
+
+        for (const auto& path : candidates)
+        {
+            if (sha256::hash_file(path) == hash) return path;
+        }
+        return {};
+    }
+
+} // namespace modpack
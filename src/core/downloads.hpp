@@ -0,0 +1,82 @@
+#pragma once
+
+// Scheduling of the downloads an install needs, a few at once. How a download is made is up to fetch,
+// whoever runs it calls complete() once it is over and pump() to start the next ones, all on one thread.
+// A failed download goes to the back of the queue until it runs out of retries.
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+
+namespace modpack {
+
+    class download_window
+    {
+    public:
+        // starts the download of id, may call complete() and pump() before it returns
+        std::function<void(const std::string& id)> fetch;
+
+        download_window(std::size_t concurrency, int max_retries)
+            : concurrency_(concurrency ? concurrency : 1), max_retries_(max_retries)
+        {
+        }
+
+        void add(std::string id)
+        {
+            queue_.push_back(std::move(id));
+            total_++;
+        }
+
+        // starts queued downloads while fewer than concurrency are in flight
+        void pump()
+        {
+            while (in_flight_ < concurrency_ && !queue_.empty())
+            {
+                auto id = std::move(queue_.front());
+                queue_.pop_front();
+                in_flight_++;
+                fetch(id);
+            }
+        }
+
+        // true when the download failed and was queued again
+        bool complete(const std::string& id, bool ok)
+        {
+            in_flight_--;
+            if (!ok && retries_[id]++ < max_retries_)
+            {
+                queue_.push_back(id);
+                return true;
+            }
+            done_++;
+            if (!ok) failed_++;
+            return false;
+        }
+
+        // nothing queued or in flight, every download is done or failed for good
+        bool idle() const { return in_flight_ == 0 && queue_.empty(); }
+
+        std::size_t total() const { return total_; }
+        std::size_t done() const { return done_; }
+        std::size_t failed() const { return failed_; }
+        std::size_t in_flight() const { return in_flight_; }
+        std::size_t concurrency() const { return concurrency_; }
+        int max_retries() const { return max_retries_; }
+
+        int retries(const std::string& id) const
+        {
+            auto found = retries_.find(id);
+            return found == retries_.end() ? 0 : found->second;
+        }
+
+    private:
+        std::size_t concurrency_;
+        int max_retries_;
+        std::deque<std::string> queue_;
+        std::map<std::string, int> retries_;
+        std::size_t total_ = 0, done_ = 0, failed_ = 0, in_flight_ = 0;
+    };
+
+} // namespace modpack
@@ -0,0 +1,219 @@
+#pragma once
+
+// Install planner: works out what installing a pack does to the dirs it routes files to,
+// then applies that. Packages found in the store are linked, the rest of the pack files are extracted
+// (files already matching their entry are left alone), a delta goes on top of its base and drops
+// what it removes. Entries the pack brings no package for are left to the caller to download.
+
+#include <core/delta.hpp>
+#include <core/store.hpp>
+
+#include <map>
+#include <set>
+
+namespace modpack {
+
+    using routes = miniz_cpp::extract_routes;
+
+    // the layout of a geode dir: packages in mods, mod config in config, mod saves in saves
+    inline routes routes_for(const std::filesystem::path& mods, const std::filesystem::path& config, const std::filesystem::path& saves)
+    {
+        return { { "mods/", mods }, { "config/", config }, { "saves/", saves } };
+    }
+
+    inline std::filesystem::path route_dir(const routes& routes, const std::string& prefix)
+    {
+        for (const auto& route : routes)
+        {
+            if (route.first == prefix) return route.second;
+        }
+        return {};
+    }
+
+    struct install_plan
+    {
+        json entries;                                  // entries once installed, a delta's merged onto its base
+        std::vector<std::string> removed_entries;      // ids a delta drops from its base
+        std::filesystem::path pack, base;              // archives files are extracted from, either may be empty
+        std::vector<std::pair<std::string, std::filesystem::path>> links;   // blob hash, destination
+        std::vector<miniz_cpp::extract_job> extract_base, extract;
+        std::vector<std::filesystem::path> remove;
+        std::vector<std::string> unresolved;           // ids having no package in the pack or the store
+        std::vector<std::string> unsafe;               // pack file names and entry ids that would land outside of their dir
+    };
+
+    struct install_result
+    {
+        std::size_t linked = 0, extracted = 0, unchanged = 0, removed = 0, stored = 0;
+        std::vector<std::string> failed_links;
+    };
+
+    // delta bases are looked for in packs_dir. throws if the pack or its base can't be read
+    inline install_plan plan_install(const pack& source, const routes& routes, const store* store, const std::filesystem::path& packs_dir)
+    {
+        perf::span span("install.plan");
+        install_plan plan;
+        plan.entries = source.entries().is_object() ? source.entries() : json::object();
+        if (source.archive()) plan.pack = source.path();
+
+        std::set<std::string> removed;
+        pack base;
+        if (source.is_delta())
+        {
+            auto base_path = find_delta_base(source.delta(), packs_dir);
+            if (base_path.empty()) throw std::runtime_error("base pack of the delta wasn't found");
+            base = pack::open(base_path);
+            if (base.archive()) plan.base = base_path;
+
+            // base entries without the removed ones, then the delta's
+            plan.entries = base.entries().is_object() ? base.entries() : json::object();
+            for (const auto& id : source.delta()["removed_entries"].elements())
+            {
+                plan.removed_entries.push_back(id.as_string());
+                plan.entries.erase(id.as_string());
+            }
+            for (const auto& [id, entry] : source.entries().items()) plan.entries[id] = entry;
+            for (const auto& name : source.delta()["removed"].elements()) removed.insert(name.as_string());
+        }
+
+        std::vector<std::string> unsafe_ids;
+        for (const auto& [id, data] : plan.entries.items())
+        {
+            if (!entry { id, data }.has_safe_id()) unsafe_ids.push_back(id);
+        }
+        for (const auto& id : unsafe_ids)
+        {
+            plan.entries.erase(id);
+            plan.unsafe.push_back(id);
+        }
+
+        // packages already in the store are linked, not extracted
+        auto mods = route_dir(routes, "mods/");
+        std::set<std::string> linked;
+        for (const auto& [id, data] : plan.entries.items())
+        {
+            auto mod = entry { id, data };
+            if (!store || mods.empty() || !mod.has_safe_package() || !store->has(mod.blob())) continue;
+            plan.links.emplace_back(mod.blob(), mods / mod.package());
+            linked.insert("mods/" + mod.package());
+        }
+
+        plan.extract = miniz_cpp::route_entries(source.files(), routes, [&](const std::string& name) {
+            return linked.count(name) > 0;
+        }, &plan.unsafe);
+        std::set<std::string> overridden;
+        for (const auto& info : source.files()) overridden.insert(info.filename);
+        plan.extract_base = miniz_cpp::route_entries(base.files(), routes, [&](const std::string& name) {
+            return linked.count(name) || removed.count(name) || overridden.count(name);
+        }, &plan.unsafe);
+
+        for (const auto& name : removed)
+        {
+            // a package linked from the store replaces the base's copy, removing it would drop the link
+            if (linked.count(name)) continue;
+            auto path = miniz_cpp::route_entry(name, routes);
+            if (!path.empty()) plan.remove.push_back(path);
+        }
+
+        std::set<std::string> provided = linked;
+        for (const auto* files : { &source.files(), &base.files() })
+        {
+            for (const auto& info : *files) provided.insert(info.filename);
+        }
+        for (const auto& [id, data] : plan.entries.items())
+        {
+            auto mod = entry { id, data };
+            auto package = mod.has_safe_package() ? mod.package() : id + ".geode";
+            if (!provided.count("mods/" + package)) plan.unresolved.push_back(id);
+        }
+
+        return plan;
+    }
+
+    struct install_options
+    {
+        modpack::store* store = nullptr;               // extracted packages having a blob are put in it
+        miniz_cpp::extract_cache* cache = nullptr;
+        miniz_cpp::extract_progress progress = {};     // over base and pack files together
+        std::size_t threads = 0;
+    };
+
+    // throws on extraction errors, failing links are only reported
+    inline install_result apply(const install_plan& plan, const install_options& options = {})
+    {
+        install_result result;
+
+        for (const auto& [hash, dest] : plan.links)
+        {
+            perf::span span("install.link", dest.filename().string());
+            if (options.store && options.store->install(hash, dest)) result.linked++;
+            else result.failed_links.push_back(dest.filename().string());
+        }
+
+        auto total = plan.extract_base.size() + plan.extract.size();
+        auto extract = [&](const std::filesystem::path& archive, const std::vector<miniz_cpp::extract_job>& jobs, std::size_t offset) {
+            if (archive.empty() || jobs.empty()) return;
+            miniz_cpp::zip_file zip;
+            zip.load_file(archive.string());
+            miniz_cpp::extract_progress progress;
+            if (options.progress) progress = [&options, offset, total](std::size_t done, std::size_t) {
+                options.progress(offset + done, total);
+            };
+            result.extracted += miniz_cpp::extract_entries(zip, jobs, progress, options.threads, options.cache);
+        };
+        extract(plan.base, plan.extract_base, 0);
+        extract(plan.pack, plan.extract, plan.extract_base.size());
+        result.unchanged = total - result.extracted;
+
+        perf::span remove("install.remove");
+        for (const auto& path : plan.remove)
+        {
+            std::error_code err;
+            if (std::filesystem::remove(path, err)) result.removed++;
+        }
+        remove.finish();
+
+        // keep extracted packages of entries having a blob for the next packs having them. blobs the store
+        // has already are a stat away, only the others are hashed
+        if (options.store)
+        {
+            perf::span span("install.store");
+            std::uint64_t stored_bytes = 0;
+            std::map<std::string, std::string> packages;
+            for (const auto& [id, data] : plan.entries.items())
+            {
+                auto mod = entry { id, data };
+                if (mod.has_safe_package() && !mod.blob().empty()) packages["mods/" + mod.package()] = mod.blob();
+            }
+            for (const auto* jobs : { &plan.extract_base, &plan.extract })
+            {
+                for (const auto& [info, dest] : *jobs)
+                {
+                    auto package = packages.find(info.filename);
+                    if (package == packages.end() || options.store->has(package->second) || !std::filesystem::exists(dest)) continue;
+                    if (options.store->put(dest).empty()) continue;
+                    result.stored++;
+                    stored_bytes += info.file_size;
+                }
+            }
+            span.bytes_in(stored_bytes);
+        }
+
+        return result;
+    }
+
+    // settings.json and saved.json of every entry having them, as the game writes them to its mods save dir.
+    // entries with an unsafe id are left out, plan_install reports them
+    inline std::vector<std::pair<std::filesystem::path, std::string>> entry_data_files(const json& entries, const std::filesystem::path& saves)
+    {
+        std::vector<std::pair<std::filesystem::path, std::string>> files;
+        for (const auto& [id, data] : entries.items())
+        {
+            if (!entry { id, data }.has_safe_id()) continue;
+            if (data.contains("settings")) files.emplace_back(saves / id / "settings.json", data["settings"].dump());
+            if (data.contains("saved")) files.emplace_back(saves / id / "saved.json", data["saved"].dump());
+        }
+        return files;
+    }
+
+} // namespace modpack
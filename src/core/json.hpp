@@ -0,0 +1,488 @@
+#pragma once
+
+// Small JSON value for the pack logic that builds without Geode (matjson comes with the SDK).
+// Objects keep their insertion order and numbers keep their source text, so lists round-trip as written.
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace modpack {
+
+    class json
+    {
+    public:
+        enum class type { null, boolean, number, string, array, object };
+
+        using array_t = std::vector<json>;
+        using object_t = std::vector<std::pair<std::string, json>>;
+
+        json() = default;
+        json(std::nullptr_t) {}
+        json(bool value) : type_(type::boolean), bool_(value) {}
+        json(std::string value) : type_(type::string), text_(std::move(value)) {}
+        json(const char* value) : type_(type::string), text_(value) {}
+        json(array_t value) : type_(type::array), array_(std::move(value)) {}
+        json(object_t value) : type_(type::object), object_(std::move(value)) {}
+
+        template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>>>
+        json(T value) : type_(type::number)
+        {
+            char buffer[32];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            text_.assign(buffer, result.ptr);
+        }
+
+        static json array() { return array_t(); }
+        static json object() { return object_t(); }
+
+        type kind() const { return type_; }
+        bool is_null() const { return type_ == type::null; }
+        bool is_bool() const { return type_ == type::boolean; }
+        bool is_number() const { return type_ == type::number; }
+        bool is_string() const { return type_ == type::string; }
+        bool is_array() const { return type_ == type::array; }
+        bool is_object() const { return type_ == type::object; }
+
+        // accessors give the fallback when the value is of another type
+        bool as_bool(bool fallback = false) const
+        {
+            return is_bool() ? bool_ : fallback;
+        }
+
+        std::string as_string(std::string fallback = {}) const
+        {
+            return is_string() ? text_ : fallback;
+        }
+
+        double as_double(double fallback = 0) const
+        {
+            if (!is_number()) return fallback;
+            return std::strtod(text_.c_str(), nullptr);
+        }
+
+        std::uint64_t as_uint(std::uint64_t fallback = 0) const
+        {
+            if (!is_number()) return fallback;
+            std::uint64_t value = 0;
+            auto result = std::from_chars(text_.data(), text_.data() + text_.size(), value);
+            if (result.ec == std::errc() && result.ptr == text_.data() + text_.size()) return value;
+            auto real = as_double();
+            return real >= 0 ? static_cast<std::uint64_t>(real) : fallback;
+        }
+
+        // members of an object, elements of an array, 0 for anything else
+        std::size_t size() const
+        {
+            return is_object() ? object_.size() : is_array() ? array_.size() : 0;
+        }
+
+        bool contains(const std::string& key) const
+        {
+            return find(key) != nullptr;
+        }
+
+        // turns null into an empty object and adds missing keys, like matjson does
+        json& operator[](const std::string& key)
+        {
+            if (is_null()) *this = object();
+            if (!is_object()) throw std::runtime_error("json: \"" + key + "\" of a value that isn't an object");
+            for (auto& member : object_)
+            {
+                if (member.first == key) return member.second;
+            }
+            object_.emplace_back(key, json());
+            return object_.back().second;
+        }
+
+        // null for missing keys and non objects
+        const json& operator[](const std::string& key) const
+        {
+            static const json null;
+            auto found = find(key);
+            return found ? *found : null;
+        }
+
+        bool erase(const std::string& key)
+        {
+            for (auto it = object_.begin(); it != object_.end(); ++it)
+            {
+                if (it->first != key) continue;
+                object_.erase(it);
+                return true;
+            }
+            return false;
+        }
+
+        // turns null into an empty array
+        void push_back(json value)
+        {
+            if (is_null()) *this = array();
+            if (!is_array()) throw std::runtime_error("json: push_back to a value that isn't an array");
+            array_.push_back(std::move(value));
+        }
+
+        // empty unless the value is of that type
+        const object_t& items() const { return object_; }
+        object_t& items() { return object_; }
+        const array_t& elements() const { return array_; }
+        array_t& elements() { return array_; }
+
+        // objects compare regardless of member order
+        bool operator==(const json& other) const
+        {
+            if (type_ != other.type_) return false;
+            switch (type_)
+            {
+            case type::null: return true;
+            case type::boolean: return bool_ == other.bool_;
+            case type::number: return text_ == other.text_ || as_double() == other.as_double();
+            case type::string: return text_ == other.text_;
+            case type::array: return array_ == other.array_;
+            case type::object:
+                if (object_.size() != other.object_.size()) return false;
+                for (const auto& member : object_)
+                {
+                    auto found = other.find(member.first);
+                    if (!found || !(*found == member.second)) return false;
+                }
+                return true;
+            }
+            return false;
+        }
+
+        bool operator!=(const json& other) const { return !(*this == other); }
+
+        // compact unless indent is given
+        std::string dump(int indent = 0) const
+        {
+            std::string out;
+            write(out, indent, 0);
+            return out;
+        }
+
+        // throws std::runtime_error naming the offset of the first error
+        static json parse(std::string_view text)
+        {
+            parser state { text };
+            state.skip_space();
+            auto value = state.value(0);
+            state.skip_space();
+            if (state.pos != text.size()) state.fail("trailing characters");
+            return value;
+        }
+
+    private:
+        const json* find(const std::string& key) const
+        {
+            for (const auto& member : object_)
+            {
+                if (member.first == key) return &member.second;
+            }
+            return nullptr;
+        }
+
+        static void write_string(std::string& out, const std::string& text)
+        {
+            out += '"';
+            for (unsigned char c : text)
+            {
+                switch (c)
+                {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (c < 0x20)
+                    {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        out += escaped;
+                    }
+                    else out += static_cast<char>(c);
+                }
+            }
+            out += '"';
+        }
+
+        void write(std::string& out, int indent, int depth) const
+        {
+            auto newline = [&](int level) {
+                if (indent <= 0) return;
+                out += '\n';
+                out.append(static_cast<std::size_t>(indent * level), ' ');
+            };
+
+            switch (type_)
+            {
+            case type::null: out += "null"; break;
+            case type::boolean: out += bool_ ? "true" : "false"; break;
+            case type::number: out += text_; break;
+            case type::string: write_string(out, text_); break;
+            case type::array:
+                out += '[';
+                for (std::size_t i = 0; i < array_.size(); i++)
+                {
+                    if (i) out += ',';
+                    newline(depth + 1);
+                    array_[i].write(out, indent, depth + 1);
+                }
+                if (!array_.empty()) newline(depth);
+                out += ']';
+                break;
+            case type::object:
+                out += '{';
+                for (std::size_t i = 0; i < object_.size(); i++)
+                {
+                    if (i) out += ',';
+                    newline(depth + 1);
+                    write_string(out, object_[i].first);
+                    out += indent > 0 ? ": " : ":";
+                    object_[i].second.write(out, indent, depth + 1);
+                }
+                if (!object_.empty()) newline(depth);
+                out += '}';
+                break;
+            }
+        }
+
+        struct parser
+        {
+            // deep enough for any list, shallow enough that a crafted one can't exhaust the stack
+            static constexpr int max_depth = 256;
+
+            std::string_view text;
+            std::size_t pos = 0;
+
+            [[noreturn]] void fail(const char* what) const
+            {
+                throw std::runtime_error(std::string("json: ") + what + " at offset " + std::to_string(pos));
+            }
+
+            void skip_space()
+            {
+                while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) pos++;
+            }
+
+            bool consume(std::string_view word)
+            {
+                if (text.substr(pos, word.size()) != word) return false;
+                pos += word.size();
+                return true;
+            }
+
+            json value(int depth)
+            {
+                if (depth > max_depth) fail("nesting too deep");
+                if (pos >= text.size()) fail("unexpected end");
+
+                switch (text[pos])
+                {
+                case '{': return object(depth);
+                case '[': return array(depth);
+                case '"': return json(string());
+                case 't': if (consume("true")) return json(true); break;
+                case 'f': if (consume("false")) return json(false); break;
+                case 'n': if (consume("null")) return json(); break;
+                default: return number();
+                }
+                fail("unexpected character");
+            }
+
+            json object(int depth)
+            {
+                json out = json::object();
+                pos++;
+                skip_space();
+                if (pos < text.size() && text[pos] == '}')
+                {
+                    pos++;
+                    return out;
+                }
+                while (true)
+                {
+                    skip_space();
+                    if (pos >= text.size() || text[pos] != '"') fail("expected a key");
+                    auto key = string();
+                    skip_space();
+                    if (pos >= text.size() || text[pos] != ':') fail("expected ':'");
+                    pos++;
+                    skip_space();
+                    out[key] = value(depth + 1);
+                    skip_space();
+                    if (pos < text.size() && text[pos] == ',')
+                    {
+                        pos++;
+                        continue;
+                    }
+                    if (pos < text.size() && text[pos] == '}')
+                    {
+                        pos++;
+                        return out;
+                    }
+                    fail("expected ',' or '}'");
+                }
+            }
+
+            json array(int depth)
+            {
+                json out = json::array();
+                pos++;
+                skip_space();
+                if (pos < text.size() && text[pos] == ']')
+                {
+                    pos++;
+                    return out;
+                }
+                while (true)
+                {
+                    skip_space();
+                    out.array_.push_back(value(depth + 1));
+                    skip_space();
+                    if (pos < text.size() && text[pos] == ',')
+                    {
+                        pos++;
+                        continue;
+                    }
+                    if (pos < text.size() && text[pos] == ']')
+                    {
+                        pos++;
+                        return out;
+                    }
+                    fail("expected ',' or ']'");
+                }
+            }
+
+            unsigned hex4()
+            {
+                if (pos + 4 > text.size()) fail("truncated escape");
+                unsigned value = 0;
+                for (int i = 0; i < 4; i++)
+                {
+                    auto c = text[pos++];
+                    value <<= 4;
+                    if (c >= '0' && c <= '9') value |= static_cast<unsigned>(c - '0');
+                    else if (c >= 'a' && c <= 'f') value |= static_cast<unsigned>(c - 'a' + 10);
+                    else if (c >= 'A' && c <= 'F') value |= static_cast<unsigned>(c - 'A' + 10);
+                    else fail("bad escape");
+                }
+                return value;
+            }
+
+            static void append_utf8(std::string& out, unsigned code)
+            {
+                if (code < 0x80) out += static_cast<char>(code);
+                else if (code < 0x800)
+                {
+                    out += static_cast<char>(0xC0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else if (code < 0x10000)
+                {
+                    out += static_cast<char>(0xE0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else
+                {
+                    out += static_cast<char>(0xF0 | (code >> 18));
+                    out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
+
+            std::string string()
+            {
+                std::string out;
+                pos++;
+                while (true)
+                {
+                    if (pos >= text.size()) fail("unterminated string");
+                    auto c = text[pos++];
+                    if (c == '"') return out;
+                    if (static_cast<unsigned char>(c) < 0x20) fail("control character in string");
+                    if (c != '\\')
+                    {
+                        out += c;
+                        continue;
+                    }
+
+                    if (pos >= text.size()) fail("unterminated string");
+                    switch (text[pos++])
+                    {
+                    case '"': out += '"'; break;
+                    case '\\': out += '\\'; break;
+                    case '/': out += '/'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    case 't': out += '\t'; break;
+                    case 'u':
+                    {
+                        auto code = hex4();
+                        if (code >= 0xD800 && code < 0xDC00 && consume("\\u"))
+                        {
+                            auto low = hex4();
+                            if (low < 0xDC00 || low >= 0xE000) fail("bad surrogate pair");
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        append_utf8(out, code);
+                        break;
+                    }
+                    default: fail("bad escape");
+                    }
+                }
+            }
+
+            json number()
+            {
+                auto start = pos;
+                auto digits = [&] {
+                    auto from = pos;
+                    while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') pos++;
+                    return pos > from;
+                };
+
+                if (pos < text.size() && text[pos] == '-') pos++;
+                if (pos < text.size() && text[pos] == '0') pos++;
+                else if (!digits()) fail("unexpected character");
+                if (pos < text.size() && text[pos] == '.')
+                {
+                    pos++;
+                    if (!digits()) fail("bad number");
+                }
+                if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E'))
+                {
+                    pos++;
+                    if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) pos++;
+                    if (!digits()) fail("bad number");
+                }
+
+                json out;
+                out.type_ = type::number;
+                out.text_ = std::string(text.substr(start, pos - start));
+                return out;
+            }
+        };
+
+        type type_ = type::null;
+        bool bool_ = false;
+        std::string text_;
+        array_t array_;
+        object_t object_;
+    };
+
+} // namespace modpack
@@ -0,0 +1,144 @@
+#pragma once
+
+// Modlist model and pack files, without Geode. A modlist (.geode_modlist) is the list json alone,
+// a modpack (.geode_modpack) is a zip of the list (this.geode_modlist) and the files it brings:
+// mods/<package>.geode, config/<mod id>/..., saves/<mod id>/..., plus about.md or README.md and logo.png or pack.png.
+// Errors are thrown as std::runtime_error, like miniz_cpp does.
+
+#include <core/json.hpp>
+#include <zip_file.hpp>
+#include <sha256.hpp>
+#include <perf.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace modpack {
+
+    constexpr auto list_entry = "this.geode_modlist";
+
+    // file name and source path of every file a pack is written from
+    using file_list = std::vector<std::pair<std::string, std::filesystem::path>>;
+
+    // by extension, a half written "x.geode_modpack.part" or a "x.geode_modpack.bak" is neither
+    inline bool is_archive(const std::filesystem::path& path)
+    {
+        return path.extension() == ".geode_modpack";
+    }
+
+    inline bool is_pack_file(const std::filesystem::path& path)
+    {
+        return is_archive(path) || path.extension() == ".geode_modlist";
+    }
+
+    inline std::string read_text(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) throw std::runtime_error("couldn't open " + path.string());
+        std::stringstream stream;
+        stream << file.rdbuf();
+        return stream.str();
+    }
+
+    // names from a pack that become a path component, one with dirs in it could point anywhere
+    inline bool is_safe_name(const std::string& name)
+    {
+        return !name.empty() && std::filesystem::path(name).filename().string() == name && name != "." && name != "..";
+    }
+
+    // entries of a pack are mod ids mapped to what the pack knows of the mod:
+    // package (file name of its .geode), blob (sha256 of it in the store), settings and saved data
+    struct entry
+    {
+        std::string id;
+        const json& data;
+
+        std::string package() const { return data["package"].as_string(); }
+        std::string blob() const { return data["blob"].as_string(); }
+
+        bool has_safe_package() const { return is_safe_name(package()); }
+
+        // ids name the save dir of the mod and the package downloaded for it
+        bool has_safe_id() const { return is_safe_name(id); }
+    };
+
+    class pack
+    {
+    public:
+        // reads the list and, for archives, the file index and about text. throws if either is unreadable
+        static pack open(const std::filesystem::path& path)
+        {
+            pack out;
+            out.path_ = path;
+            if (!is_archive(path))
+            {
+                out.list_ = json::parse(read_text(path));
+                return out;
+            }
+
+            miniz_cpp::zip_file zip;
+            zip.load_file(path.string());
+            if (!zip.has_file(list_entry)) throw std::runtime_error(path.string() + " has no " + list_entry);
+            out.list_ = json::parse(zip.read(list_entry));
+            out.files_ = zip.infolist();
+            for (auto name : { "README.md", "about.md" })
+            {
+                if (!zip.has_file(name)) continue;
+                out.about_ = zip.read(name);
+                break;
+            }
+            return out;
+        }
+
+        // just the list, for callers that don't need the files
+        static json read_list(const std::filesystem::path& path)
+        {
+            if (!is_archive(path)) return json::parse(read_text(path));
+
+            miniz_cpp::zip_file zip;
+            zip.load_file(path.string());
+            if (!zip.has_file(list_entry)) throw std::runtime_error(path.string() + " has no " + list_entry);
+            return json::parse(zip.read(list_entry));
+        }
+
+        const std::filesystem::path& path() const { return path_; }
+        bool archive() const { return is_archive(path_); }
+
+        const json& list() const { return list_; }
+        json& list() { return list_; }
+
+        std::string name() const { return list_["name"].as_string(); }
+        std::string creator() const { return list_["creator"].as_string(); }
+
+        // the about.md or README.md of the archive, the list's own about otherwise
+        std::string about() const { return about_.empty() ? list_["about"].as_string() : about_; }
+
+        const json& entries() const { return list_["entries"]; }
+        bool is_delta() const { return list_["delta"].is_object(); }
+        const json& delta() const { return list_["delta"]; }
+
+        // empty for plain modlists
+        const std::vector<miniz_cpp::zip_info>& files() const { return files_; }
+
+        bool has_file(const std::string& name) const
+        {
+            for (const auto& info : files_)
+            {
+                if (info.filename == name) return true;
+            }
+            return false;
+        }
+
+        std::string hash() const { return sha256::hash_file(path_); }
+
+    private:
+        std::filesystem::path path_;
+        json list_;
+        std::vector<miniz_cpp::zip_info> files_;
+        std::string about_;
+    };
+
+} // namespace modpack
@@ -0,0 +1,157 @@
+#pragma once
+
+// Content addressed store of .geode packages shared by all packs, keyed by their sha256.
+// Packs may reference packages by hash, installs link them from here instead of extracting copies.
+// Blobs are read-only copies of the packages put in. Installs get writable clones of them where the fs
+// can make those (apfs, btrfs, xfs), plain copies elsewhere.
+
+#include <sha256.hpp>
+#include <perf.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+
+#if defined(__APPLE__)
+#include <sys/clonefile.h>
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace modpack {
+
+    class store
+    {
+    public:
+        explicit store(std::filesystem::path dir) : dir_(std::move(dir)) {}
+
+        const std::filesystem::path& dir() const { return dir_; }
+
+        std::filesystem::path blob(const std::string& hash) const
+        {
+            return dir_ / hash.substr(0, 2) / (hash + ".geode");
+        }
+
+        static bool valid_hash(const std::string& hash)
+        {
+            return hash.size() == 64 && std::all_of(hash.begin(), hash.end(), [](char c) {
+                return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+            });
+        }
+
+        // copy on write clone where the fs can do it
+        static bool clone(const std::filesystem::path& from, const std::filesystem::path& to)
+        {
+#if defined(__APPLE__)
+            return clonefile(from.c_str(), to.c_str(), 0) == 0;
+#elif defined(__linux__) && defined(FICLONE)
+            auto src = ::open(from.c_str(), O_RDONLY);
+            if (src < 0) return false;
+            auto dst = ::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            auto cloned = dst >= 0 && ::ioctl(dst, FICLONE, src) == 0;
+            if (dst >= 0) ::close(dst);
+            ::close(src);
+            std::error_code err;
+            if (!cloned) std::filesystem::remove(to, err);
+            return cloned;
+#else
+            return false;
+#endif
+        }
+
+        // clone, else a plain copy. never shares data the source's owner could rewrite
+        static bool copy(const std::filesystem::path& from, const std::filesystem::path& to)
+        {
+            std::error_code err;
+            std::filesystem::create_directories(to.parent_path(), err);
+            std::filesystem::remove(to, err);
+            if (clone(from, to)) return true;
+            err.clear();
+            std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, err);
+            return !err;
+        }
+
+        // copy() made writable, for blobs going out of the store. no hardlinks: the game, its updater and
+        // later installs replace or rewrite packages in place, which a read-only blob would refuse
+        // (windows won't even rename over one) and a writable one would let corrupt the store
+        static bool link(const std::filesystem::path& from, const std::filesystem::path& to)
+        {
+            if (!copy(from, to)) return false;
+            std::error_code err;
+            std::filesystem::permissions(to, std::filesystem::perms::owner_write, std::filesystem::perm_options::add, err);
+            return !err;
+        }
+
+        // blobs are copies marked read-only when put. a writable one comes from a store that hardlinked
+        // packages into it, it's rehashed once and dropped if it doesn't match its name anymore
+        bool has(const std::string& hash) const
+        {
+            if (!valid_hash(hash)) return false;
+            std::error_code err;
+            auto path = blob(hash);
+            auto status = std::filesystem::status(path, err);
+            if (err || !std::filesystem::is_regular_file(status)) return false;
+            if ((status.permissions() & std::filesystem::perms::owner_write) == std::filesystem::perms::none) return true;
+            if (sha256::hash_file(path) == hash)
+            {
+                // a hardlink to a live package stays one, it's swapped for a copy of its own
+                auto links = std::filesystem::hard_link_count(path, err);
+                if (!err && links > 1) return seal_copy(path, path);
+                return seal(path);
+            }
+            std::filesystem::remove(path, err);
+            return false;
+        }
+
+        // adds a copy of package to the store unless it's there already, returns its hash or empty string on failure
+        std::string put(const std::filesystem::path& package) const
+        {
+            perf::span span("store.put", package.filename().string());
+            std::error_code size_err;
+            auto size = std::filesystem::file_size(package, size_err);
+            if (!size_err) span.bytes_in(size);
+
+            auto hash = sha256::hash_file(package);
+            if (hash.empty() || has(hash)) return hash;
+            return seal_copy(package, blob(hash)) ? hash : "";
+        }
+
+        // a clone of the blob at dest where the fs can do it, a copy otherwise. a dest hardlinked to the
+        // blob by an older install is replaced the same way
+        bool install(const std::string& hash, const std::filesystem::path& dest) const
+        {
+            return link(blob(hash), dest);
+        }
+
+    private:
+        static bool seal(const std::filesystem::path& path)
+        {
+            std::error_code err;
+            std::filesystem::permissions(path, std::filesystem::perms::owner_write | std::filesystem::perms::group_write | std::filesystem::perms::others_write,
+                std::filesystem::perm_options::remove, err);
+            return !err;
+        }
+
+        // copies from to a .part next to path, seals it and moves it in place
+        static bool seal_copy(const std::filesystem::path& from, const std::filesystem::path& path)
+        {
+            auto part = std::filesystem::path(path).concat(".part");
+            std::error_code err;
+            if (!copy(from, part) || !seal(part))
+            {
+                std::filesystem::remove(part, err);
+                return false;
+            }
+            std::filesystem::rename(part, path, err);
+            if (!err) return true;
+            std::filesystem::remove(part, err);
+            return false;
+        }
+
+        std::filesystem::path dir_;
+    };
+
+} // namespace modpack
@@ -3,20 +3,14 @@
 #include <Geode/utils/web.hpp>
 
 #include <zip_file.hpp>
-
-uint32_t fnv1a_hash(const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) return 0;
-
-    uint32_t hash = 2166136261u;
-    char c;
-    while (file.get(c)) {
-        hash ^= static_cast<uint8_t>(c);
-        hash *= 16777619u;
-    }
-    return hash;
-}
-
+#include <xxhash.hpp>
+#include <sha256.hpp>
+#include <perf.hpp>
+#include <progress.hpp>
+#include <tasks.hpp>
+#include <core/create.hpp>
+#include <core/downloads.hpp>
+#include <core/install.hpp>
 
 using namespace geode::prelude; 
 
@@ -24,7 +18,20 @@ using namespace geode::prelude;
 
 static auto dark_themed = false;
 
-inline CCTexture2D* createTextureFromPNGData(const std::vector<uint8_t>& pngData) {
+//queueInMainThread that shows up in traces, the wait in the queue and the callback itself
+template <class F> void queueInMainThreadTraced(const char* name, F&& callback) {
+    if (!perf::trace::enabled()) return queueInMainThread(std::forward<F>(callback));
+    static std::atomic_uint64_t ids = 0;
+    queueInMainThread([name, id = ++ids, queued = perf::trace::now(), callback = std::forward<F>(callback)]() mutable {
+        perf::trace::async(std::string(name) + " (queued)", "", id, queued, perf::trace::now() - queued);
+        auto scope = perf::trace::scope(name);
+        callback();
+    });
+}
+
+//png to pixels, safe off main thread. the image is the caller's to release
+inline CCImage* decodePNG(const std::vector<uint8_t>& pngData) {
+    auto scope = perf::trace::scope("png.decode");
     CCImage* image = new CCImage();
     bool success = image->initWithImageData((void*)pngData.data(), pngData.size(), CCImage::kFmtPng);
     if (!success) {
@@ -32,17 +39,67 @@ inline CCTexture2D* createTextureFromPNGData(const std::vector<uint8_t>& pngData
         image->release();
         return nullptr;
     }
+    return image;
+}
 
-    CCTexture2D* texture = new CCTexture2D();
-    if (!texture->initWithImage(image)) {
-        log::error("Failed to create CCTexture2D from CCImage.");
-        texture->release();
-        image->release();
-        return nullptr;
+//textures of decoded images are made on main thread, as many as fit in a few ms of a frame.
+//a list of packs with big logos gets them over some frames instead of one long hitch
+struct TextureUploads {
+    using Done = std::function<void(CCTexture2D*)>;
+
+    inline static std::mutex mutex;
+    inline static std::deque<std::pair<CCImage*, Done>> queue;
+    inline static bool queued = false;
+    static constexpr auto budget = std::chrono::milliseconds(4);
+
+    //from any thread. done gets an autoreleased texture on main thread, null when there was no image
+    static void push(CCImage* image, Done done) {
+        auto lock = std::lock_guard(mutex);
+        queue.emplace_back(image, std::move(done));
+        if (std::exchange(queued, true)) return;
+        queueInMainThread(pump);
     }
 
-    image->release(); // Texture holds its own copy now
-    return texture;
+    //one call a frame while anything is left, there's always at least one upload
+    static void pump() {
+        auto started = std::chrono::steady_clock::now();
+        while (true) {
+            auto next = std::pair<CCImage*, Done>();
+            {
+                auto lock = std::lock_guard(mutex);
+                if (queue.empty()) {
+                    queued = false;
+                    return;
+                }
+                if (std::chrono::steady_clock::now() - started > budget) return queueInMainThread(pump);
+                next = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            auto [image, done] = std::move(next);
+            CCTexture2D* texture = nullptr;
+            if (image) {
+                auto scope = perf::trace::scope("texture.upload");
+                texture = new CCTexture2D();
+                if (texture->initWithImage(image)) texture->autorelease();
+                else {
+                    log::error("Failed to create CCTexture2D from CCImage.");
+                    texture->release();
+                    texture = nullptr;
+                }
+                image->release(); // Texture holds its own copy now
+            }
+            if (done) done(texture);
+        }
+    }
+};
+
+//read and decoded on the task pool, only the texture is made on main thread (see TextureUploads)
+inline void createTextureFromPNGAsync(std::function<std::vector<uint8_t>()> read, TextureUploads::Done done) {
+    tasks::pool::shared().submit([read = std::move(read), done = std::move(done)]() mutable {
+        auto png = read();
+        TextureUploads::push(png.size() ? decodePNG(png) : nullptr, std::move(done));
+    }, tasks::priority::ui);
 }
 
 //aaaaaaaaaaaaaaaaaaaaaaaaaa
@@ -62,6 +119,23 @@ public:
     }
 };
 
+//runs a callback when the node leaves the scene, like the popup it's in being closed
+class ExitListener : public CCNode {
+public:
+    std::function<void()> m_onExit;
+    static ExitListener* create(std::function<void()> onExit) {
+        auto ret = new ExitListener();
+        ret->m_onExit = std::move(onExit);
+        ret->init();
+        ret->autorelease();
+        return ret;
+    }
+    void onExit() override {
+        CCNode::onExit();
+        if (m_onExit) m_onExit();
+    }
+};
+
 class Modpack : public CCObject {
     void loadLogo(std::string link) {
         Ref loading_action = CCRepeatForever::create(CCSequence::create(
@@ -74,7 +148,9 @@ class Modpack : public CCObject {
         listener->bind([this, loading_action, link](web::WebTask::Event* e)
             {
                 if (web::WebResponse* res = e->getValue()) {
-                    if (auto a = createTextureFromPNGData(res->data())) {
+                    auto scope = perf::trace::scope("web.logo", link);
+                    createTextureFromPNGAsync([data = res->data()] { return data; }, [logo = logo, loading_action, link](CCTexture2D* a) {
+                        if (!a) return;
                         //apply texture
                         if (logo) {
                             if (loading_action) logo->stopAction(loading_action);
@@ -87,18 +163,50 @@ class Modpack : public CCObject {
                                 a, { {0,0}, a->getContentSize() }
                             ), link.c_str()
                         );
-                    };
+                    });
                 };
             }
         );
         auto req = web::WebRequest();
         listener->setFilter(req.get(link));
     }
+    //logo from a png, the base logo shows until it's decoded. key keeps it in the sprite frame cache for the next time
+    void loadLogoPNG(std::function<std::vector<uint8_t>()> read, std::string key = "") {
+        logo->initWithSpriteFrameName("geode.loader/logo-base.png");
+        if (key.size() and CCSpriteFrameCache::get()->m_pSpriteFrames->objectForKey(key.c_str())) {
+            logo->initWithSpriteFrameName(key.c_str());
+            return;
+        }
+        createTextureFromPNGAsync(std::move(read), [logo = logo, key](CCTexture2D* texture) {
+            if (!texture) return;
+            logo->initWithTexture(texture);
+            if (key.size()) CCSpriteFrameCache::get()->addSpriteFrame(
+                CCSpriteFrame::createWithTexture(texture, { {0,0}, texture->getContentSize() }), key.c_str()
+            );
+        });
+    }
+    void applyLogo(std::string val) {
+        logo->initWithSpriteFrameName("geode.loader/logo-base.png");
+
+        static const std::regex link_regex(R"(^(https?|ftp)://[^\s/$.?#].[^\s]*$)", std::regex::icase);
+        if (std::regex_match(val, link_regex)) {
+            if (CCSpriteFrameCache::get()->m_pSpriteFrames->objectForKey(val.c_str())) {
+                logo->initWithSpriteFrameName(val.c_str());
+            }
+            else loadLogo(val);
+        }
+        else {
+            if (fileExistsInSearchPaths(val.c_str())) logo->initWithFile(val.c_str());
+            else logo->initWithSpriteFrameName(val.c_str());
+        }
+    }
 public:
     std::filesystem::path path;
     matjson::Value data;
     std::string about;
     Ref<CCSprite> logo;
+    std::vector<uint8_t> logo_png;
+    size_t entries_count = 0;
 
     bool include_settings_data = true;
     bool include_saved_data = false;
@@ -106,80 +214,234 @@ public:
     bool include_config = true;
     bool include_saves = false;
 
-    inline static auto packsLoadPoints = std::map<std::filesystem::path, uint32_t>{};
-    inline static auto loadedPacks = std::map<std::filesystem::path, Ref<Modpack>>{};
+    bool use_store = false;
 
-    void loadFromFile(std::filesystem::path path) {
-        this->path = CCFileUtils::get()->fullPathForFilename(path.string().c_str(), false);
-        if (string::contains(path.string(), ".geode_modpack")) {
-            auto size = packsLoadPoints.contains(path) ? packsLoadPoints[path] : 0;
-            auto size_mismatch = size != fnv1a_hash(path.string());
-            if (not size_mismatch) {
-                auto loaded = loadedPacks[path].data();
-                data = loaded->data;
-                about = loaded->about;
-                if (loaded->logo) logo->setDisplayFrame(loaded->logo->displayFrame());
-                include_settings_data = loaded->include_settings_data;
-                include_saved_data = loaded->include_saved_data;
-                include_config = loaded->include_config;
-                include_saves = loaded->include_saves;
-            }
-            else if (auto file_open = file::CCMiniZFile::create(path.string())) {
-                auto file = file_open.unwrapOrDefault();
+    std::filesystem::path delta_base; //pack to make a delta of, empty for a full pack
 
-                if (auto read = file->read("this.geode_modlist")) {
-                    data = matjson::parse(read.unwrapOrDefault()).unwrapOrDefault();
-                } else log::error("failed to read this.geode_modlist, {}", read.err().value_or("unk err"));
+    //persistent metadata of pack files, so packs list don't have to open every archive
+    struct Index {
+        inline static auto data = matjson::Value();
+        inline static auto loaded = false;
+        inline static auto dirty = false;
 
-                if (auto read = file->read("about.md")) {
-                    about = read.unwrapOrDefault();
-                }
-                else log::warn("failed to read about.md, {}", read.err().value_or("unk err"));
+        static std::filesystem::path location() { return getMod()->getSaveDir() / "packs_index.json"; }
+        static std::string key(std::filesystem::path const& path) {
+            return CCFileUtils::get()->fullPathForFilename(path.string().c_str(), false);
+        }
+        static std::filesystem::path thumbnails() { return getMod()->getSaveDir() / "thumbnails"; }
 
-                if (auto read = file->read("README.md")) {
-                    about = read.unwrapOrDefault();
-                }
-                else log::info("failed to read README.md, {}", read.err().value_or("unk err"));
+        static matjson::Value& get() {
+            if (!loaded) {
+                loaded = true;
+                if (std::filesystem::exists(location())) data = file::readJson(location()).unwrapOrDefault();
+                if (!data.isObject()) data = matjson::Value();
+            }
+            return data;
+        }
 
-                if (auto read = file->readAsCCTexture("logo.png")) {
-                    logo->initWithTexture(read.unwrapOrDefault());
-                }
-                else log::warn("failed to read logo.png, {}", read.err().value_or("unk err"));
+        //size and mtime, any change of them makes the entry stale
+        static std::string stamp(std::filesystem::path const& path) {
+            auto size_err = std::error_code();
+            auto mtime_err = std::error_code();
+            auto size = std::filesystem::file_size(path, size_err);
+            auto mtime = std::filesystem::last_write_time(path, mtime_err).time_since_epoch().count();
+            return size_err or mtime_err ? "" : fmt::format("{}:{}", size, mtime);
+        }
 
-                if (auto read = file->readAsCCTexture("pack.png")) {
-                    logo->initWithTexture(read.unwrapOrDefault());
-                }
-                else log::info("failed to read pack.png, {}", read.err().value_or("unk err"));
+        //has an entry that still matches the file
+        static bool fresh(std::filesystem::path const& path) {
+            auto& index = get();
+            auto key = Index::key(path);
+            auto stamp = Index::stamp(path);
+            return index.contains(key) and stamp.size() and index[key]["stamp"].asString().unwrapOrDefault() == stamp;
+        }
+
+        static void remove(std::string const& key) {
+            auto& index = get();
+            if (!index.contains(key)) return;
+            auto err = std::error_code();
+            auto thumbnail = index[key]["thumbnail"].asString().unwrapOrDefault();
+            if (thumbnail.size()) std::filesystem::remove(thumbnail, err);
+            index.erase(key);
+            dirty = true;
+        }
 
-                loadedPacks[path] = this;
-                packsLoadPoints[path] = std::filesystem::file_size(path);
+        //drops entries of files that are gone
+        static void prune(std::vector<std::filesystem::path> const& keep) {
+            auto keys = std::set<std::string>();
+            for (auto& path : keep) keys.insert(key(path));
+            auto stale = std::vector<std::string>();
+            for (auto& entry : get()) {
+                auto key = entry.getKey().value_or("");
+                if (!keys.contains(key)) stale.push_back(key);
             }
+            for (auto& key : stale) remove(key);
         }
-        else {
-            auto read = file::readJson(path).unwrapOrDefault();
-            data = read;
-        };
 
-        if (data.contains("logo")) {
-            logo->initWithSpriteFrameName("geode.loader/logo-base.png");
-            auto val = data["logo"].asString().unwrapOrDefault();
+        static void save() {
+            if (!dirty) return;
+            dirty = false;
+            auto wrote = file::writeString(location(), data.dump());
+            if (!wrote) log::error("failed to save packs index, {}", wrote.err().value_or("unk err"));
+        }
+    };
 
-            static const std::regex link_regex(R"(^(https?|ftp)://[^\s/$.?#].[^\s]*$)", std::regex::icase);
-            if (std::regex_match(val, link_regex)) {
-                if (CCSpriteFrameCache::get()->m_pSpriteFrames->objectForKey(val.c_str())) {
-                    logo->initWithSpriteFrameName(val.c_str());
-                }
-                else loadLogo(val);
+    //content addressed store of .geode packages shared by all packs, see core/store.hpp
+    struct Store {
+        static std::filesystem::path location() { return getMod()->getSaveDir() / "store"; }
+        static modpack::store get() { return modpack::store(location()); }
+    };
+
+    //crc of files on disk by their size and mtime, shared by installs and delta creation
+    static std::filesystem::path extractCache() { return getMod()->getSaveDir() / "extract_cache.txt"; }
+
+    //starts timing a create/install, and its trace when the record-trace setting is on
+    static void startPerfSession(std::string const& name) {
+        perf::session::get().reset(name);
+        if (getMod()->getSettingValue<bool>("record-trace")) perf::trace::start();
+    }
+
+    //timings of the last create/install go to perf/<name>.json, the perf-summary setting shows them too.
+    //a trace recorded along goes to perf/<name>.trace.json
+    static void savePerfReport(std::string const& name) {
+        auto dir = getMod()->getSaveDir() / "perf";
+        auto err = std::error_code();
+        std::filesystem::create_directories(dir, err);
+        auto res = file::writeString(dir / (name + ".json"), perf::session::get().to_json());
+        if (!res) log::error("failed to save perf report, {}", res.err().value_or("unk err"));
+
+        if (!perf::trace::enabled()) return;
+        perf::trace::stop();
+        res = file::writeString(dir / (name + ".trace.json"), perf::trace::to_json());
+        if (!res) log::error("failed to save trace, {}", res.err().value_or("unk err"));
+    }
+
+    bool loadFromIndex(std::filesystem::path path) {
+        if (!Index::fresh(path)) return false;
+        auto key = Index::key(path);
+        auto entry = Index::get()[key];
+
+        this->path = key;
+        data["name"] = entry["name"];
+        data["creator"] = entry["creator"];
+        about = entry["about"].asString().unwrapOrDefault();
+        entries_count = entry["entries"].asUInt().unwrapOrDefault();
+        include_settings_data = entry["include_settings_data"].asBool().unwrapOr(include_settings_data);
+        include_saved_data = entry["include_saved_data"].asBool().unwrapOr(include_saved_data);
+
+        //a logo key wins over the png, like in loadFromFile
+        auto thumbnail = entry["thumbnail"].asString().unwrapOrDefault();
+        if (entry.contains("logo")) applyLogo(entry["logo"].asString().unwrapOrDefault());
+        else if (thumbnail.size() and std::filesystem::exists(thumbnail)) loadLogoPNG([thumbnail] { return file::readBinary(thumbnail).unwrapOrDefault(); }, thumbnail);
+
+        return true;
+    }
+
+    void saveToIndex() {
+        auto key = Index::key(path);
+        auto stamp = Index::stamp(path);
+        if (stamp.empty()) return;
+
+        Index::remove(key);
+
+        auto entry = matjson::Value();
+        entry["stamp"] = stamp;
+        entry["name"] = data["name"];
+        entry["creator"] = data["creator"];
+        entry["about"] = about;
+        entry["entries"] = entries_count;
+        entry["include_settings_data"] = include_settings_data;
+        entry["include_saved_data"] = include_saved_data;
+        if (data.contains("logo")) entry["logo"] = data["logo"];
+
+        //no thumbnail when the logo key is what's shown
+        else if (logo_png.size()) {
+            auto thumbnail = Index::thumbnails() / fmt::format("{:016x}.png", std::hash<std::string>{}(key + stamp));
+            auto err = std::error_code();
+            std::filesystem::create_directories(Index::thumbnails(), err);
+            if (file::writeBinary(thumbnail, logo_png)) entry["thumbnail"] = thumbnail.string();
+        }
+
+        Index::get()[key] = entry;
+        Index::dirty = true;
+    }
+
+    //what loadFromFile takes from a pack file, read without touching cocos so it can run on the task pool
+    struct Contents {
+        std::string list;
+        std::string about;
+        std::vector<uint8_t> logo_png;
+    };
+
+    static Contents readFile(std::filesystem::path path) {
+        auto span = perf::span("pack.load", path.filename().string());
+        auto size_err = std::error_code();
+        auto size = std::filesystem::file_size(path, size_err);
+        if (!size_err) span.bytes_in(size);
+
+        auto out = Contents();
+        if (!modpack::is_archive(path)) {
+            out.list = file::readString(path).unwrapOrDefault();
+            return out;
+        }
+
+        try {
+            auto zip = miniz_cpp::zip_file();
+            zip.load_file(path.string());
+
+            if (zip.has_file("this.geode_modlist")) out.list = zip.read("this.geode_modlist");
+            else log::error("failed to read this.geode_modlist, not in {}", path);
+
+            //README.md wins over about.md, pack.png over logo.png
+            for (auto name : { "README.md", "about.md" }) if (zip.has_file(name)) {
+                out.about = zip.read(name);
+                break;
             }
-            else {
-                if (fileExistsInSearchPaths(val.c_str())) logo->initWithFile(val.c_str());
-                else logo->initWithSpriteFrameName(val.c_str());
+            for (auto name : { "pack.png", "logo.png" }) if (zip.has_file(name)) {
+                auto read = zip.read(name);
+                out.logo_png.assign(read.begin(), read.end());
+                break;
             }
         }
+        catch (std::exception const& e) { log::error("failed to read pack {}, {}", path, e.what()); }
+        return out;
+    }
+
+    //reads the packs the index has nothing fresh for side by side on the task pool, then gives them to done on the main thread.
+    //done runs right away when every pack is fresh
+    static void readFiles(std::vector<std::filesystem::path> const& files, std::function<void(std::map<std::filesystem::path, std::shared_ptr<Contents>>)> done) {
+        auto stale = std::vector<std::filesystem::path>();
+        for (auto& file : files) {
+            if (cocos::fileExistsInSearchPaths(file.string().c_str()) and !Index::fresh(file)) stale.push_back(file);
+        }
+        if (stale.empty()) return done({});
+        tasks::run_then_main(tasks::priority::ui, [stale] {
+            auto out = std::map<std::filesystem::path, std::shared_ptr<Contents>>();
+            auto group = tasks::group(tasks::priority::ui);
+            for (auto& file : stale) {
+                auto contents = out[file] = std::make_shared<Contents>();
+                group.run([file, contents] { *contents = readFile(file); });
+            }
+            group.wait();
+            return out;
+            }, std::move(done));
+    }
+
+    void loadFromFile(std::filesystem::path path, Contents contents) {
+        this->path = CCFileUtils::get()->fullPathForFilename(path.string().c_str(), false);
+        data = matjson::parse(contents.list).unwrapOrDefault();
+        about = contents.about;
+        logo_png = std::move(contents.logo_png);
+
+        //a logo key wins over the png
+        if (data.contains("logo")) applyLogo(data["logo"].asString().unwrapOrDefault());
+        else if (logo_png.size()) loadLogoPNG([png = logo_png] { return png; });
 
         include_settings_data = string::contains(data.dump(), "\"settings\":") ? true : include_settings_data;
         include_saved_data = string::contains(data.dump(), "\"saved\":") ? true : include_saved_data;
 
+        entries_count = data["entries"].size();
+
         about = about.size() ? about : data["about"].asString().unwrapOr(
             "\n" "# " + data["name"].asString().unwrapOrDefault() +
             "\n" "Created by " + data["creator"].asString().unwrapOrDefault() +
@@ -188,13 +450,16 @@ public:
         );
     }
 
-    Modpack(std::filesystem::path path = "") {
+    //metadata_only allows to take pack info from index without opening the file, read is what readFiles got of it
+    Modpack(std::filesystem::path path = "", bool metadata_only = false, std::shared_ptr<Contents> read = nullptr) {
         data["name"] = GameManager::get()->m_playerName.c_str() + std::string("'s modpack");
         data["creator"] = GameManager::get()->m_playerName.c_str();
         logo = CCSprite::create();
 
         if (cocos::fileExistsInSearchPaths(path.string().c_str())) {
-            loadFromFile(path);
+            if (metadata_only and loadFromIndex(path)) return;
+            loadFromFile(path, read ? std::move(*read) : readFile(path));
+            saveToIndex();
         }
     }
 };
@@ -223,11 +488,26 @@ public:
     auto inline static NEXT_SETUP_TYPE = std::string("");
     auto inline static NEXT_CUSTOM_SETUP = std::function<void(CCLayer*)>();
 
-    auto inline static STATUS_TITLE = std::string("");
-    auto inline static STATUS_PERCENTAGE = std::string("");
     auto inline static STATUS_SHOW_LIST = { "status-label", "status-percentage-label", "loading-spinner" };
-    auto inline static HIDE_STATUS = false;
-    auto inline static SHOW_RESTART_BUTTON = false;
+
+    //progress of installs and downloads, pushed from any thread without locking
+    inline static progress::channel PROGRESS;
+
+    //what status labels show, drained from PROGRESS at most once per frame. main thread only
+    static progress::status const& status() {
+        static auto status = progress::status();
+        static auto frame = ~0u;
+        auto now = CCDirector::get()->getTotalFrames();
+        if (frame != now) {
+            frame = now;
+            status.drain(PROGRESS);
+        }
+        return status;
+    }
+
+    static std::string statusPercentage(progress::status::job const* job) {
+        return job ? fmt::format("{}%  ", (int)(job->fraction * 100)) : "";
+    }
 
     struct ModpackCreator {
         inline static Modpack* MODPACK;
@@ -321,36 +601,76 @@ public:
             switchToScene(ModsList::create());
         }
 
-        static void create() {
+        //lines of the create log the popup shows, the earlier ones are only counted
+        inline static size_t LOG_WINDOW = 60;
+
+        static std::string renderLog(progress::log_ring::snapshot const& tail, std::string const& status) {
+            auto out = std::string("```");
+            if (tail.dropped) out += fmt::format("\n... {} earlier lines", tail.dropped);
+            for (auto& line : tail.lines) out += "\n" + line;
+            out += "\n```\n";
+            if (status.size()) out += "**" + status + "**\n";
+            return out + tail.footer;
+        }
+
+        //files written so far and time left, empty until writing starts
+        static std::string jobStatus(modpack::create_job const& job) {
+            auto state = job.snapshot();
+            if (!state.entries_total or state.entries_done == state.entries_total) return "";
+            auto out = fmt::format("{}/{} files, {}%", state.entries_done, state.entries_total, (int)(state.fraction() * 100));
+            if (state.reused) out += fmt::format(", {} reused", state.reused);
+            if (state.eta >= 0) out += fmt::format(", about {}s left", (int)state.eta + 1);
+            return out;
+        }
+
+        static void create(std::shared_ptr<modpack::create_job> job = nullptr) {
 
             static Ref<MDPopup> progress_popup;
             static Ref<MDTextArea> mdArea;
-            static std::string mdAreaStr;
-            if (!progress_popup or !progress_popup->isRunning()) {
-                mdAreaStr = "```";
-                progress_popup = MDPopup::create("creating modpack...", mdAreaStr, "close");
+            static auto createLog = progress::log_ring(512);
+            if (!job) {
+                if (progress_popup and progress_popup->isRunning()) return;
+                createLog.clear();
+                job = std::make_shared<modpack::create_job>();
+                progress_popup = MDPopup::create("creating modpack...", renderLog(createLog.tail(LOG_WINDOW), ""), "close");
                 popupCustomSetup(progress_popup.data());
                 progress_popup->show();
 
+                //closing the popup cancels creation, files compressed by then are kept for the next try
+                progress_popup->addChild(ExitListener::create([job] { job->cancel(); }));
+
+                //redraws the tail of the log, only when something was logged or written since the last time
                 progress_popup->runAction(CCRepeatForever::create(CCSpawn::create(CallFuncExt::create(
-                    [] {
+                    [job, drawn = createLog.sequence(), shown = std::string()]() mutable {
+                        auto status = jobStatus(*job);
+                        if (!mdArea or (drawn == createLog.sequence() and shown == status)) return;
+                        auto tail = createLog.tail(LOG_WINDOW);
+                        drawn = tail.sequence;
+                        shown = status;
                         auto scrollea = mdArea->getScrollLayer()->m_contentLayer->getPositionY();
-                        if (mdAreaStr != mdArea->getString()) mdArea->setString(mdAreaStr.c_str());
+                        mdArea->setString(renderLog(tail, status).c_str());
                         mdArea->getScrollLayer()->m_contentLayer->setPositionY(scrollea);
                     }
                 ), CCDelayTime::create(0.3f), nullptr)));
 
                 mdArea = progress_popup->m_mainLayer->getChildByType<MDTextArea>(0);
 
-                return std::thread(create).detach();
+                return tasks::pool::shared().submit([job] { create(job); }, tasks::priority::background);
             }
 
+            //a cancelled creation may still be finishing its last files, they share the checkpoint
+            static std::mutex running;
+            auto lock = std::lock_guard(running);
+
 #define logToMDPopup(str, ...) { log::info(str, __VA_ARGS__);\
-                mdAreaStr = ((mdAreaStr + std::string("\n") + fmt::format(str, __VA_ARGS__)).c_str());\
+                createLog.push(fmt::format(str, __VA_ARGS__));\
             }
 
             auto filename = MODPACK->data["name"].asString().unwrapOrDefault();
 
+            Modpack::startPerfSession("create");
+            auto span = perf::span("create");
+
             std::ranges::for_each(filename, [](char& c) {
                 if (!std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '-')
                     c = '_';
@@ -358,32 +678,45 @@ public:
 
             logToMDPopup("creating \"{}\" pack", filename);
 
+            //deltas never take the base's place
+            auto base_path = MODPACK->delta_base;
+            if (!base_path.empty()) filename += "_delta";
+
             auto list_path = getMod()->getConfigDir() / (filename + ".geode_modlist");
             auto pack_path = getMod()->getConfigDir() / (filename + ".geode_modpack");
 
             auto packit = false;
-            auto zipper = file::CCMiniZFile::create(pack_path.string()).unwrapOrDefault();
 
             auto& list = MODPACK->data;
+            auto files = std::vector<std::pair<std::string, std::filesystem::path>>(); //name in zip, source
 
             //xd
             MODS_SELECTED.erase("geode.loader");
             MODS_SELECTED.erase(getMod()->getID());
 
             for (auto sel : MODS_SELECTED) {
-                if (!mdArea or !mdArea->isRunning()) {
-                    packit = 0;
-                    continue;
-                }
+                if (job->cancelled()) break;
+                auto entry = matjson::Value();
                 if (sel.second) {
                     logToMDPopup("adding files of {} (ptr ok? - {})", sel.first, (bool)sel.second);
                     packit = true;
                     auto packagep = sel.second->getPackagePath();
-                    zipper->write(
-                        packagep.string(), 
-                        file::readBinary(std::filesystem::path() / "mods" / packagep.filename()).unwrapOrDefault()
-                    );
-                    logToMDPopup("package added, {}", sel.second->getPackagePath());
+                    //packs using the store reference the package there, installs of any pack having it link it from there
+                    auto hash = MODPACK->use_store
+                        ? Modpack::Store::get().put(std::filesystem::path() / "mods" / packagep.filename())
+                        : std::string();
+                    if (hash.size()) {
+                        entry["blob"] = hash;
+                        entry["package"] = packagep.filename().string();
+                    }
+                    if (hash.empty()) {
+                        files.emplace_back(
+                            (std::filesystem::path("mods") / packagep.filename()).generic_string(),
+                            std::filesystem::path() / "mods" / packagep.filename()
+                        );
+                        logToMDPopup("package added, {}", sel.second->getPackagePath());
+                    }
+                    else logToMDPopup("package referenced from store, {}", hash);
                     if (MODPACK->include_config) {
                         auto dir = dirs::getModConfigDir() / sel.second->getID() / "";
                         auto atzip = std::filesystem::path() / "config";
@@ -394,10 +727,7 @@ public:
                             //00000000 mod.id/ ...........++
                             auto name = std::filesystem::path(path).filename();
                             auto rel = std::string(str.begin() + str.rfind(id), str.end());
-                            if (path.has_filename()) zipper->write(
-                                (atzip / rel / name).string(),
-                                file::readBinary(path).unwrapOrDefault()
-                            );
+                            if (path.has_filename()) files.emplace_back((atzip / rel / name).generic_string(), path);
                         }
                     }
                     if (MODPACK->include_saves) {
@@ -410,16 +740,12 @@ public:
                             //00000000 mod.id/ ...........++
                             auto name = std::filesystem::path(path).filename();
                             auto rel = std::string(str.begin() + str.rfind(id), str.end());
-                            if (path.has_filename()) zipper->write(
-                                (atzip / rel / name).string(),
-                                file::readBinary(path).unwrapOrDefault()
-                            );
+                            if (path.has_filename()) files.emplace_back((atzip / rel / name).generic_string(), path);
                         }
                         //todo  , ?
                     }
                 }
                 logToMDPopup("adding {} entry", sel.first);
-                auto entry = matjson::Value();
                 if (Loader::get()->isModInstalled(sel.first)) {
                     auto mod = Loader::get()->getInstalledMod(sel.first);
 
@@ -446,25 +772,78 @@ public:
                 logToMDPopup("{} entry added!\n", sel.first);
             }
 
-            auto err = std::error_code();
-            if (!packit) std::filesystem::remove(pack_path, err);
-            if (err.message().size()) log::error("({}) {}", err.value(), err.message());
-
-            if (!mdArea or !mdArea->isRunning()) return;
+            //delta keeps only what differs from the base, plus what the base has and this pack doesn't
+            auto result_list = list;
+            if (!base_path.empty() and !job->cancelled()) {
+                logToMDPopup("making delta of {}", base_path.filename());
+                auto cache = miniz_cpp::extract_cache::load(Modpack::extractCache());
+                auto delta = modpack::json::parse(list.dump(matjson::NO_INDENTATION));
+                auto made = false;
+                try {
+                    made = modpack::make_delta(delta, files, modpack::pack::open(base_path), *cache);
+                }
+                catch (std::exception const& e) { log::error("failed to read base pack, {}", e.what()); }
+
+                if (!made) logToMDPopup("{} is a delta itself or unreadable, creating full pack", base_path.filename())
+                else {
+                    result_list = matjson::parse(delta.dump()).unwrapOrDefault();
+                    logToMDPopup(
+                        "delta has {} files and {} entries, removes {} files and {} entries",
+                        files.size(), result_list["entries"].size(),
+                        result_list["delta"]["removed"].size(), result_list["delta"]["removed_entries"].size()
+                    );
+                }
 
-            logToMDPopup("{}", "creating list...");
-            if (packit) zipper->write("this.geode_modlist", list.dump());
-            else file::writeString(list_path, list.dump());
+                try { cache->save(); }
+                catch (std::exception const& e) { log::error("failed to save extract cache, {}", e.what()); }
+            }
 
-            if (packit) zipper->save();
+            if (job->cancelled()) {
+                logToMDPopup("{}", "cancelled");
+                return;
+            }
 
             std::filesystem::path result_path = packit ? pack_path : list_path;
+
+            //compressed files of an interrupted creation of this pack, taken as they are when nothing changed
+            auto checkpoint = modpack::create_checkpoint(getMod()->getSaveDir() / "create_checkpoint" / result_path.filename());
+            //ones of other packs not tried again for a week are given up on
+            modpack::create_checkpoint::prune(checkpoint.dir().parent_path(), std::chrono::hours(24 * 7), checkpoint.dir());
+            auto options = modpack::write_options();
+            options.job = job.get();
+            options.checkpoint = &checkpoint;
+            options.priority = tasks::priority::background;
+
+            logToMDPopup("writing {} files and the list...", files.size());
+            try {
+                modpack::write_pack(result_path, modpack::json::parse(result_list.dump(matjson::NO_INDENTATION)), files, options);
+            }
+            catch (modpack::cancelled const&) {
+                auto state = job->snapshot();
+                logToMDPopup("cancelled, {} of {} files are kept for the next try", state.entries_done, state.entries_total);
+                return;
+            }
+            catch (std::exception const& e) {
+                logToMDPopup("failed to write {}, {}", result_path.filename(), e.what());
+                return;
+            }
+            checkpoint.clear();
+
+            auto state = job->snapshot();
+            if (state.reused) logToMDPopup("{} of {} files taken from the last try", state.reused, state.entries_total);
+
             auto result_name = std::filesystem::path(result_path).filename();
-            logToMDPopup(
-                "```\n- created \"[{}](file://{})\" pack!", 
+            auto result = fmt::format(
+                "- created \"[{}](file://{})\" pack!", 
                 string::replace(result_name.string(), "\\", "/"), 
                 string::replace(result_path.string(), "\\", "/")
             );
+            log::info("{}", result);
+
+            span.finish();
+            Modpack::savePerfReport("create");
+            if (getMod()->getSettingValue<bool>("perf-summary")) result += "\n" + perf::session::get().summary();
+            createLog.set_footer(result);
 
         }
 
@@ -496,6 +875,13 @@ public:
             body_stream << fmt::format(
                 "- [include saves](http://e.ee): {} (only works for modpacks)", MODPACK->include_saves
             ) << std::endl;
+            body_stream << fmt::format(
+                "- [use packages store](http://e.ee): {} (pack refers to .geode files by hash instead of including them, installs only where the store has them)", MODPACK->use_store
+            ) << std::endl;
+            body_stream << fmt::format(
+                "- [delta of](http://e.ee): {} (pack keeps only changes to that pack and installs on top of it)",
+                MODPACK->delta_base.empty() ? "none" : MODPACK->delta_base.filename().string()
+            ) << std::endl;
 
             body_stream << std::string(
                 "### Selected mods:"
@@ -639,6 +1025,22 @@ public:
                 MODPACK->include_saves = !MODPACK->include_saves;
                 recreate_poup();
                 });
+            assign_to_link("use packages store", [link] {
+                MODPACK->use_store = !MODPACK->use_store;
+                recreate_poup();
+                });
+            assign_to_link("delta of", [link] {
+                //cycles through packs in config dir, then back to none
+                auto packs = std::vector<std::filesystem::path>();
+                for (auto& path : file::readDirectory(getMod()->getConfigDir()).unwrapOrDefault()) {
+                    if (modpack::is_pack_file(path)) packs.push_back(path);
+                }
+                std::ranges::sort(packs);
+                auto next = std::ranges::upper_bound(packs, MODPACK->delta_base);
+                if (MODPACK->delta_base.empty()) next = packs.begin();
+                MODPACK->delta_base = next == packs.end() ? std::filesystem::path() : *next;
+                recreate_poup();
+                });
 
             popupCustomSetup(popup.data());
             popup->show();
@@ -803,79 +1205,211 @@ public:
 
     };
 
-    inline static void installPack(Modpack* pack, bool restart = false) {
+    //downloads of pack mods, a few at once. web events are dispatched on main thread so no locking here
+    struct PackDownloads {
+        inline static auto MAX_RETRIES = 2;
+
+        Ref<Modpack> pack;
+        bool restart = false;
+        bool finished = false;
+        modpack::download_window window = modpack::download_window(concurrency(), MAX_RETRIES);
+        std::map<std::string, float> progress;
+        std::map<std::string, double> started; //perf session time, per download
+        std::map<std::string, double> traceStarted;
+        std::vector<std::unique_ptr<EventListener<web::WebTask>>> listeners;
+
+        static size_t concurrency() {
+            return std::clamp<int64_t>(getMod()->getSettingValue<int64_t>("download-concurrency"), 1, 16);
+        }
 
-        if (pack->data.contains("files_installed")) void();
-        else {
-            pack->data["files_installed"] = true;
+        void updateStatus(std::string const& id) {
+            auto done = window.done(), total = window.total();
+            auto sum = done * 1.f;
+            for (auto& [_, value] : progress) sum += value / 100.f;
+            PROGRESS.push({ "install", fmt::format("{} ({}/{})", id, done, total), total ? sum / total : 1. });
+        }
 
-            auto unzip_path = dirs::getTempDir() / ZipUtils::base64URLEncode(pack->data["name"].dump()).c_str();
-            if (auto unzip = file::CCMiniZFile::create(pack->path.string())) {
-                unzip.unwrapOrDefault()->extractAll(unzip_path.string());
+        static void pump(std::shared_ptr<PackDownloads> self) {
+            self->window.pump();
+            if (self->window.idle()) finish(self);
+        }
 
-                auto options =
-                    std::filesystem::copy_options::recursive |
-                    std::filesystem::copy_options::overwrite_existing;
-                std::error_code err;
+        //what the window fetches with, window then holds self until finish drops it
+        static void begin(std::shared_ptr<PackDownloads> self) {
+            self->window.fetch = [self](std::string const& id) { start(self, id); };
+            pump(self);
+        }
 
-                std::filesystem::copy(unzip_path / "mods", dirs::getModsDir(), options, err);
-                std::filesystem::copy(unzip_path / "config", dirs::getModConfigDir(), options, err);
-                std::filesystem::copy(unzip_path / "saves", dirs::getModsSaveDir(), options, err);
-            };
+        static void start(std::shared_ptr<PackDownloads> self, std::string id) {
+            self->progress[id] = 0.f;
+            self->started[id] = perf::session::get().now();
+            self->traceStarted[id] = perf::trace::now();
+            self->updateStatus(id);
+
+            std::string ver = "latest";
+            auto url = "https://api.geode-sdk.org/v1/mods/" + id + "/versions/" + ver + "/download";
+
+            auto req = web::WebRequest();
+            auto listener = std::make_unique<EventListener<web::WebTask>>();
+            listener->bind(
+                [self, id](web::WebTask::Event* e) {
+                    auto scope = perf::trace::scope("web.download", id);
+                    if (web::WebProgress* prog = e->getProgress()) {
+                        self->progress[id] = prog->downloadProgress().value_or(0.f);
+                        self->updateStatus(id);
+                    }
+                    if (web::WebResponse* res = e->getValue()) {
+                        auto ok = res->code() < 399 and res->into(dirs::getModsDir() / (id + ".geode")).isOk();
+                        complete(self, id, ok);
+                    }
+                    else if (e->isCancelled()) complete(self, id, false);
+                }
+            );
+            listener->setFilter(req.send("GET", url));
+            self->listeners.push_back(std::move(listener));
         }
 
-        if (pack->data.contains("install_progress")) void();
-        else {
-            pack->data["install_progress"] = pack->data["entries"];
+        static void complete(std::shared_ptr<PackDownloads> self, std::string id, bool ok) {
+            self->progress.erase(id);
+
+            //downloads run on the web thread, so only wall time and size of the result here
+            auto record = perf::record();
+            record.name = ok ? "install.download" : "install.download.failed";
+            record.detail = id;
+            record.start = self->started[id];
+            record.wall = perf::session::get().now() - record.start;
+            auto size_err = std::error_code();
+            auto size = std::filesystem::file_size(dirs::getModsDir() / (id + ".geode"), size_err);
+            if (ok and !size_err) record.bytes_out = size;
+            perf::session::get().add(record);
+            perf::trace::async(record.name, id, std::hash<std::string>()(id), self->traceStarted[id], perf::trace::now() - self->traceStarted[id]);
+
+            if (self->window.complete(id, ok)) log::warn("download of {} failed, retrying ({}/{})", id, self->window.retries(id), MAX_RETRIES);
+            else if (!ok) log::error("download of {} failed", id);
+            self->updateStatus(id);
+            pump(self);
         }
 
-        auto id = std::string();
-        for (auto val : pack->data["install_progress"]) {
-            id = val.getKey().value_or("");
-            if (val.contains("settings")) {
-                file::writeString(dirs::getModsSaveDir() / id / "settings.json", val["settings"].dump());
-            }
-            if (val.contains("saved")) {
-                file::writeString(dirs::getModsSaveDir() / id / "saved.json", val["saved"].dump());
+        static void finish(std::shared_ptr<PackDownloads> self) {
+            if (self->finished) return;
+            self->finished = true;
+
+            //listeners hold this state, drop them outside of their own callbacks
+            queueInMainThreadTraced("clear download listeners", [self] {
+                self->listeners.clear();
+                self->window.fetch = nullptr;
+                });
+
+            auto record = perf::record();
+            record.name = "install";
+            record.wall = perf::session::get().now();
+            perf::session::get().add(record);
+            Modpack::savePerfReport("install");
+
+            PROGRESS.push(progress::update::finish("install"));
+            PROGRESS.push(progress::update::needs_restart());
+            if (self->restart) game::restart();
+            else if (getMod()->getSettingValue<bool>("perf-summary")) {
+                MDPopup::create("perf summary", perf::session::get().summary(), "close")->show();
             }
-            break;
         }
-        pack->data["install_progress"].erase(id);
+    };
 
-        auto mod_package = (dirs::getModsDir() / (id + ".geode"));
-        if (fileExistsInSearchPaths(mod_package.string().c_str())) return installPack(pack, restart);
+    //where pack archive entries go on install
+    inline static modpack::routes packRoutes() {
+        return modpack::routes_for(dirs::getModsDir(), dirs::getModConfigDir(), dirs::getModsSaveDir());
+    }
 
-        STATUS_PERCENTAGE = "0%  ";
+    inline static void installPack(Modpack* pack, bool restart = false) {
 
-        STATUS_TITLE = id;
-        HIDE_STATUS = STATUS_TITLE.empty();
+        if (pack->data.contains("files_installed")) void();
+        else {
+            pack->data["files_installed"] = true;
+            Modpack::startPerfSession("install");
+
+            auto archive = modpack::is_archive(pack->path);
+            auto title = pack->data.contains("delta") ? "Applying delta pack" : archive ? "Extracting pack files" : "Linking stored packages";
+            PROGRESS.push({ "install", title, 0 });
+
+            //planning, linking and extraction run off main thread, installing goes on there after it
+            pack->retain();
+            tasks::pool::shared().submit([pack, restart, path = pack->path] {
+                auto plan = modpack::install_plan();
+                auto error = std::string();
+                auto store = Modpack::Store::get();
+                //files matching their entry by size and crc are left as they are
+                auto cache = miniz_cpp::extract_cache::load(Modpack::extractCache());
+                auto span = perf::span("install.files");
+                try {
+                    //a delta goes on top of its base, packages already in the store are linked, not extracted
+                    plan = modpack::plan_install(modpack::pack::open(path), packRoutes(), &store, getMod()->getConfigDir());
+                    for (auto& name : plan.unsafe) log::warn("skipping unsafe entry {}", name);
+
+                    auto options = modpack::install_options();
+                    options.store = &store;
+                    options.cache = cache.get();
+                    options.progress = [](size_t done, size_t total) {
+                        if (done * 100 / total == (done - 1) * 100 / total) return;
+                        PROGRESS.push({ "install", "", (double)done / total });
+                    };
+                    auto result = modpack::apply(plan, options);
+                    for (auto& name : result.failed_links) log::warn("failed to link stored package {}", name);
+                }
+                catch (std::exception const& e) { error = e.what(); }
+
+                try { cache->save(); }
+                catch (std::exception const& e) { log::error("failed to save extract cache, {}", e.what()); }
+                span.finish();
+
+                if (error.size()) {
+                    log::error("failed to install pack {}, {}", path, error);
+                    queueInMainThreadTraced("install failed", [pack, error] {
+                        Notification::create("Failed to install pack: " + error, NotificationIcon::Error)->show();
+                        PROGRESS.push(progress::update::finish("install"));
+                        pack->data.erase("files_installed");
+                        pack->release();
+                    });
+                    return;
+                }
 
-        if (HIDE_STATUS) {
-            SHOW_RESTART_BUTTON = true;
-            if (restart) game::restart();
+                queueInMainThreadTraced("install entries", [pack, restart, entries = plan.entries.dump(), removed_entries = plan.removed_entries] {
+                    pack->data["entries"] = matjson::parse(entries).unwrapOrDefault();
+                    for (auto& id : removed_entries) if (auto mod = Loader::get()->getInstalledMod(id)) {
+                        if (auto res = mod->uninstall(false); !res) log::error("failed to uninstall {}, {}", id, res.err().value_or("unk err"));
+                    }
+                    installPack(pack, restart);
+                    pack->release();
+                });
+            });
             return;
         }
 
-        std::string ver = "latest";
-        auto url = "https://api.geode-sdk.org/v1/mods/" +id+ "/versions/"+ ver + "/download";
+        auto downloads = std::make_shared<PackDownloads>();
+        downloads->pack = pack;
+        downloads->restart = restart;
 
-        auto req = web::WebRequest();
-        auto listener = new EventListener<web::WebTask>;
-        listener->bind(
-            [id, pack, restart](web::WebTask::Event* e) {
-                if (web::WebProgress* prog = e->getProgress()) {
-                    STATUS_PERCENTAGE = fmt::format("{}%  ", (int)prog->downloadProgress().value_or(0.f));
-                }
-                if (web::WebResponse* res = e->getValue()) {
-                    std::string data = res->string().unwrapOr("no res");
-                    if (res->code() < 399) {
-                        res->into(dirs::getModsDir() / (id + ".geode"));
-                    }
-                    installPack(pack, restart);
-                }
+        for (auto val : pack->data["entries"]) {
+            auto id = val.getKey().value_or("");
+            //ids are dir and file names below, one with dirs in it could point anywhere
+            if (!modpack::is_safe_name(id)) {
+                log::warn("skipping unsafe entry {}", id);
+                continue;
             }
-        );
-        listener->setFilter(req.send("GET", url));
+            if (val.contains("settings")) {
+                file::writeString(dirs::getModsSaveDir() / id / "settings.json", val["settings"].dump());
+            }
+            if (val.contains("saved")) {
+                file::writeString(dirs::getModsSaveDir() / id / "saved.json", val["saved"].dump());
+            }
+
+            auto mod_package = (dirs::getModsDir() / (id + ".geode"));
+            if (fileExistsInSearchPaths(mod_package.string().c_str())) continue;
+
+            downloads->window.add(id);
+        }
+
+        PROGRESS.push({ "install", "", 0 });
+        PackDownloads::begin(downloads);
     };
 
     void setupForSelector() {
@@ -890,6 +1424,254 @@ public:
         }
     }
 
+    static void fillPacksList(ScrollLayer* scroll, std::vector<std::filesystem::path> const& files, std::map<std::filesystem::path, std::shared_ptr<Modpack::Contents>> read) {
+        for (auto file : files) {
+            auto menu = CCMenu::create();
+            menu->setContentHeight(46.000f);
+            menu->setContentWidth(scroll->getContentWidth());
+
+            scroll->m_contentLayer->addChild(menu);
+
+            auto modpack = new Modpack(file, true, read[file]);
+            menu->setUserObject("modpack", modpack);
+
+            auto container = CCNode::create();
+            container->setContentSize(menu->getContentSize());
+            container->setAnchorPoint(CCPointZero);
+
+            auto bg = CCScale9Sprite::create("square02b_small.png");
+            bg->setContentSize(menu->getContentSize() - CCSizeMake(6, 6));
+            bg->setOpacity(dark_themed ? 25 : 90);
+            bg->setColor(dark_themed ? ccWHITE : ccBLACK);
+            container->addChildAtPosition(bg, Anchor::Center, {}, false);
+
+            auto logo = modpack->logo;
+            logo->runAction(CCRepeatForever::create(CCSpawn::create(CallFuncExt::create(
+                [logo] {
+                    if (logo) logo->setAnchorPoint(CCPointMake(0.f, 0.5f));
+                    if (logo) limitNodeSize(logo, CCSizeMake(1, 1) * 32.f, 1337.f, 0.1f);
+                }
+            ), nullptr)));
+            limitNodeSize(logo, CCSizeMake(1, 1) * 32.f, 1337.f, 0.1f); ///fffffuck *offset
+            container->addChildAtPosition(logo, Anchor::Left, { 8.000f, 0 }, false);
+
+            auto offset = logo->boundingBox().size.width + 16.f;
+
+            auto name = SimpleTextArea::create(
+                modpack->data["name"].asString().unwrapOrDefault(), "bigFont.fnt", 0.500f
+            )->getLines()[0];
+            limitNodeWidth(name, 300.000f, name->getScale(), 0.1f);
+            name->setAnchorPoint(CCPointMake(0.f, 0.85f));
+            container->addChildAtPosition(name, Anchor::Left, { offset, 14.f}, false);
+
+            auto creator = SimpleTextArea::create(
+                "By: " + modpack->data["creator"].asString().unwrapOrDefault(), "goldFont.fnt", 0.42f
+            )->getLines()[0];
+            limitNodeWidth(creator, 296.000f, creator->getScale(), 0.1f);
+            creator->setAnchorPoint(CCPointMake(0.f, -0.15f));
+            container->addChildAtPosition(creator, Anchor::Left, { offset, -12.f }, false);
+
+            auto item = CCMenuItemExt::createSpriteExtra(container,
+                [file](CCNode*) {
+                    auto popup = openSettingsPopup(
+                        Loader::get()->getInstalledMod("geode.loader"), false
+                    );
+                    findFirstChildRecursive<CCNode>(
+                        popup, [&](CCNode* node){
+                            if (typeinfo_cast<CCMenuItem*>(node)) node->setVisible(false);
+                            if (node == popup) return false;
+                            if (node->getParent() != popup->m_mainLayer) return false;
+                            node->setVisible(false);
+                            return false;
+                        }
+                    );
+                    auto menu = popup->m_buttonMenu;
+                    auto layer = popup->m_mainLayer;
+
+                    menu->setVisible(true);
+                    if (auto close = menu->getChildByType<CCMenuItem>(0)) {
+                        close->setVisible(true);
+                    }
+
+                    layer->setVisible(true);
+                    if (auto bg = layer->getChildByType<CCScale9Sprite>(0)) {
+                        bg->setVisible(true);
+                    }
+
+                    auto modpack = new Modpack(file);
+                    popup->setUserObject("modpack"_spr, modpack);
+
+                    auto topBG = CCLayerColor::create({ 0,0,0,90 });
+                    topBG->setID("topBG"_spr);
+                    topBG->setContentWidth(menu->getContentWidth() - (440.000 - 435.000));
+                    topBG->setContentHeight(57.000f);
+                    topBG->setZOrder(-1);
+                    menu->addChildAtPosition(topBG, Anchor::TopLeft, { 3.f, -68.000f }, false);
+
+                    auto logo = modpack->logo;
+                    logo->setID("logo"_spr);
+                    logo->runAction(CCRepeatForever::create(CCSpawn::create(CallFuncExt::create(
+                        [logo] {
+                            if (logo) logo->setAnchorPoint(CCPointMake(0.f, 0.5f));
+                            if (logo) limitNodeSize(logo, CCSizeMake(1, 1) * 48.000f, 1337.f, 0.1f);
+                        }
+                    ), nullptr)));
+
+                    menu->addChildAtPosition(logo, Anchor::TopLeft, { 30.f, -40.f }, false);
+
+                    auto name = SimpleTextArea::create(
+                        modpack->data["name"].asString().unwrapOrDefault(), "bigFont.fnt", 0.600f
+                    )->getLines()[0];
+                    name->setID("name"_spr);
+                    limitNodeWidth(name, 226.000f, name->getScale(), 0.1f);
+                    name->setAnchorPoint(CCPointMake(0.f, 0.85f));
+                    menu->addChildAtPosition(name, Anchor::TopLeft, { 88.f, -19.f }, false);
+
+                    auto creator = SimpleTextArea::create(
+                        "By: " + modpack->data["creator"].asString().unwrapOrDefault(), "goldFont.fnt", 0.52f
+                    )->getLines()[0];
+                    creator->setID("creator"_spr);
+                    limitNodeWidth(creator, 226.000f, creator->getScale(), 0.1f);
+                    creator->setAnchorPoint(CCPointMake(0.f, -0.15f));
+                    menu->addChildAtPosition(creator, Anchor::TopLeft, { 88.000f, -49.000f }, false);
+
+                    auto file = SimpleTextArea::create(
+                        std::filesystem::path(modpack->path).filename().string(), "chatFont.fnt", 0.52f
+                    )->getLines()[0];
+                    file->setID("file"_spr);
+                    limitNodeWidth(file, 226.000f, file->getScale(), 0.1f);
+                    file->setAnchorPoint(CCPointMake(0.f, -0.15f));
+                    menu->addChildAtPosition(file, Anchor::TopLeft, { 88.000f, -62.000f }, false);
+
+                    auto about = MDTextArea::create(modpack->about, { 280.f, 198.f});
+                    about->setID("about"_spr);
+                    about->ignoreAnchorPointForPosition(1);
+                    menu->addChildAtPosition(about, Anchor::BottomLeft, { 16.000f, 10.000f }, false);
+
+                    auto is_installed = CCBool::create(true);
+                    popup->setUserObject("is_installed"_spr, is_installed);
+
+                    auto infstream = std::stringstream();
+                    infstream << "##### [EDIT PACK](http://e.ee) [DELETE](http://e.ee)" << std::endl;
+                    if (modpack->include_settings_data) infstream << "### Includes settings data" << std::endl;
+                    if (modpack->include_saved_data) infstream << "### Includes saved data" << std::endl;
+                    infstream << "## Mods list:" << std::endl;
+                    for (auto val : modpack->data["entries"]) {
+                        auto id = val.getKey().value_or("");
+
+                        infstream << fmt::format("\n\n [{0}](mod:{0})", id);
+                        if (val.contains("settings")) infstream << " `[settings]`";
+                        if (val.contains("saved")) infstream << " `[saved_data]`";
+                        infstream << std::endl;
+
+                        if (not Loader::get()->getInstalledMod(id)) is_installed->setValue(false);
+                    }
+
+                    auto inf = MDTextArea::create(infstream.str(), {139.000f, 198.f});
+                    inf->setID("inf"_spr);
+                    inf->ignoreAnchorPointForPosition(1);
+                    menu->addChildAtPosition(inf, Anchor::BottomRight, { -139.000f -1, 10.000f }, false);
+
+                    auto popup_really = popup;
+                    {
+                        typedef TextLinkedButtonWrapper LinkItem;
+                        LinkItem* link; //IntelliSence...
+                        auto popup = inf;
+                        assign_to_link(
+                            "EDIT PACK", [&] {
+                                MDPopup::create("Pack editing...",
+                                    """" "Pack edit UI is planned, but for now its goes manually. "
+                                    """" "Packs takes their places at mod config folder. "
+                                    "\n" "- \".geode_modlist\" ones is .json text files"
+                                    "\n" "- \".geode_modpack\" ones is .zip archive files"
+                                    "\n"
+                                    "\n" "You can open them using \"Open As\" function in your file manager."
+                                    "\n"
+                                    "\n" "### .geode_modpack tips"
+                                    "\n" "- You can add logo.png or pack.png"
+                                    "\n" "- You can add about.md or README.md"
+                                    "\n"
+                                    "\n" "### .geode_modlist tips"
+                                    "\n" "- You can add logo json key with texture/frame name or.. LINK!)"
+                                    "\n" "```"
+                                    "\n"
+                                    R"({
+"name": "awful mods",
+"creator": "me",
+"logo": "https://images2.imgbox.com/66/b5/erYMNC8O_o.png",
+"entries": ...
+                                    )"
+                                    "\n" "```"
+                                    , "OK")->show();
+                            }
+                        );
+                        assign_to_link(
+                            "DELETE", [modpack] {
+                                auto path = (const char*)modpack->path.u8string().c_str();
+                                auto err = std::remove(path);
+                                if (err) log::error("remove err{} for {}", err, path);
+                                NEXT_SETUP_TYPE = "setupForPacksList";
+                                switchToScene(ModsList::create());
+                            }, modpack
+                        );
+                    };
+                    
+                    auto btn_ref = findFirstChildRecursive<ButtonSprite>(popup, [](CCNode*) { return true; });
+                    btn_ref->setString(is_installed->getValue() ? "Uninstall" : "Install");
+                    btn_ref->setScale(0.825f);
+                    btn_ref->setID("setup_btn_ref"_spr);
+                    auto setup = CCMenuItemExt::createSpriteExtra(
+                        btn_ref, [popup, btn_ref, modpack, is_installed](CCNode*) {
+                            if (is_installed->getValue()) {
+                                for (auto val : modpack->data["entries"]) {
+                                    auto id = val.getKey().value_or("");
+                                    auto mod = Loader::get()->getInstalledMod(id);
+                                    if (!mod) continue;
+                                    mod->uninstall(val.contains("settings") or val.contains("saved"));
+                                }
+                                PROGRESS.push(progress::update::needs_restart());
+                            }
+                            else {
+                                popup->removeFromParent();
+                                installPack(modpack);
+                            };
+                            is_installed->setValue(!is_installed->getValue());
+                            btn_ref->setString(is_installed->getValue() ? "Uninstall" : "Install");
+                        }
+                    );
+                    setup->setID("setup_btn"_spr);
+                    menu->addChildAtPosition(setup, Anchor::TopRight, { -70.000f, -38.000f }, false);
+
+                    handleTouchPriority(popup);
+
+                }
+            );
+            item->setContentWidth(item->getContentWidth() / 2);
+            item->setAnchorPoint({ 1.f, 0.5f });
+            item->m_scaleMultiplier = 0.95f;
+            menu->addChildAtPosition(item, Anchor::Center, {}, false);
+        }
+        Modpack::Index::prune(files);
+        Modpack::Index::save();
+        scroll->m_contentLayer->setLayout(RowLayout::create()
+            ->setCrossAxisAlignment(AxisAlignment::End)
+            ->setCrossAxisOverflow(true)
+            ->setGrowCrossAxis(true)
+            ->setAxisReverse(true)
+            ->setGap(-3.f)
+        );
+        scroll->moveToTop();
+
+        static auto last_pos = CCPointMake(0, 0);
+        static auto last_size = CCSizeMake(0, 0);
+        scroll->runAction(CCRepeatForever::create(CCSpawn::create(CallFuncExt::create([scroll] {
+            last_pos = scroll->m_contentLayer->getPosition();
+            last_size = scroll->m_contentLayer->getContentSize();
+            }), CCDelayTime::create(0.1f), nullptr)));
+        if (not last_pos.isZero() and last_size.equals(scroll->m_contentLayer->getContentSize()))
+            scroll->m_contentLayer->setPosition(last_pos);
+    }
+
     void setupForPacksList() {
 
         if (auto bg = typeinfo_cast<CCLayerColor*>(this->querySelector("frame-bg"))) {
@@ -907,249 +1689,10 @@ public:
 
             auto files = file::readDirectory(getMod()->getConfigDir(), true).unwrapOrDefault();
             if (loadit_pack) files.push_back(loadit_pack->path);
-            for (auto file : files) {
-                auto menu = CCMenu::create();
-                menu->setContentHeight(46.000f);
-                menu->setContentWidth(scroll->getContentWidth());
-
-                scroll->m_contentLayer->addChild(menu);
-
-                auto modpack = new Modpack(file);
-                menu->setUserObject("modpack", modpack);
-
-                auto container = CCNode::create();
-                container->setContentSize(menu->getContentSize());
-                container->setAnchorPoint(CCPointZero);
-
-                auto bg = CCScale9Sprite::create("square02b_small.png");
-                bg->setContentSize(menu->getContentSize() - CCSizeMake(6, 6));
-                bg->setOpacity(dark_themed ? 25 : 90);
-                bg->setColor(dark_themed ? ccWHITE : ccBLACK);
-                container->addChildAtPosition(bg, Anchor::Center, {}, false);
-
-                auto logo = modpack->logo;
-                logo->runAction(CCRepeatForever::create(CCSpawn::create(CallFuncExt::create(
-                    [logo] {
-                        if (logo) logo->setAnchorPoint(CCPointMake(0.f, 0.5f));
-                        if (logo) limitNodeSize(logo, CCSizeMake(1, 1) * 32.f, 1337.f, 0.1f);
-                    }
-                ), nullptr)));
-                limitNodeSize(logo, CCSizeMake(1, 1) * 32.f, 1337.f, 0.1f); ///fffffuck *offset
-                container->addChildAtPosition(logo, Anchor::Left, { 8.000f, 0 }, false);
-
-                auto offset = logo->boundingBox().size.width + 16.f;
-
-                auto name = SimpleTextArea::create(
-                    modpack->data["name"].asString().unwrapOrDefault(), "bigFont.fnt", 0.500f
-                )->getLines()[0];
-                limitNodeWidth(name, 300.000f, name->getScale(), 0.1f);
-                name->setAnchorPoint(CCPointMake(0.f, 0.85f));
-                container->addChildAtPosition(name, Anchor::Left, { offset, 14.f}, false);
-
-                auto creator = SimpleTextArea::create(
-                    "By: " + modpack->data["creator"].asString().unwrapOrDefault(), "goldFont.fnt", 0.42f
-                )->getLines()[0];
-                limitNodeWidth(creator, 296.000f, creator->getScale(), 0.1f);
-                creator->setAnchorPoint(CCPointMake(0.f, -0.15f));
-                container->addChildAtPosition(creator, Anchor::Left, { offset, -12.f }, false);
-
-                auto item = CCMenuItemExt::createSpriteExtra(container,
-                    [file](CCNode*) {
-                        auto popup = openSettingsPopup(
-                            Loader::get()->getInstalledMod("geode.loader"), false
-                        );
-                        findFirstChildRecursive<CCNode>(
-                            popup, [&](CCNode* node){
-                                if (typeinfo_cast<CCMenuItem*>(node)) node->setVisible(false);
-                                if (node == popup) return false;
-                                if (node->getParent() != popup->m_mainLayer) return false;
-                                node->setVisible(false);
-                                return false;
-                            }
-                        );
-                        auto menu = popup->m_buttonMenu;
-                        auto layer = popup->m_mainLayer;
-
-                        menu->setVisible(true);
-                        if (auto close = menu->getChildByType<CCMenuItem>(0)) {
-                            close->setVisible(true);
-                        }
-
-                        layer->setVisible(true);
-                        if (auto bg = layer->getChildByType<CCScale9Sprite>(0)) {
-                            bg->setVisible(true);
-                        }
-
-                        auto modpack = new Modpack(file);
-                        popup->setUserObject("modpack"_spr, modpack);
-
-                        auto topBG = CCLayerColor::create({ 0,0,0,90 });
-                        topBG->setID("topBG"_spr);
-                        topBG->setContentWidth(menu->getContentWidth() - (440.000 - 435.000));
-                        topBG->setContentHeight(57.000f);
-                        topBG->setZOrder(-1);
-                        menu->addChildAtPosition(topBG, Anchor::TopLeft, { 3.f, -68.000f }, false);
-
-                        auto logo = modpack->logo;
-                        logo->setID("logo"_spr);
-                        logo->runAction(CCRepeatForever::create(CCSpawn::create(CallFuncExt::create(
-                            [logo] {
-                                if (logo) logo->setAnchorPoint(CCPointMake(0.f, 0.5f));
-                                if (logo) limitNodeSize(logo, CCSizeMake(1, 1) * 48.000f, 1337.f, 0.1f);
-                            }
-                        ), nullptr)));
-
-                        menu->addChildAtPosition(logo, Anchor::TopLeft, { 30.f, -40.f }, false);
-
-                        auto name = SimpleTextArea::create(
-                            modpack->data["name"].asString().unwrapOrDefault(), "bigFont.fnt", 0.600f
-                        )->getLines()[0];
-                        name->setID("name"_spr);
-                        limitNodeWidth(name, 226.000f, name->getScale(), 0.1f);
-                        name->setAnchorPoint(CCPointMake(0.f, 0.85f));
-                        menu->addChildAtPosition(name, Anchor::TopLeft, { 88.f, -19.f }, false);
-
-                        auto creator = SimpleTextArea::create(
-                            "By: " + modpack->data["creator"].asString().unwrapOrDefault(), "goldFont.fnt", 0.52f
-                        )->getLines()[0];
-                        creator->setID("creator"_spr);
-                        limitNodeWidth(creator, 226.000f, creator->getScale(), 0.1f);
-                        creator->setAnchorPoint(CCPointMake(0.f, -0.15f));
-                        menu->addChildAtPosition(creator, Anchor::TopLeft, { 88.000f, -49.000f }, false);
-
-                        auto file = SimpleTextArea::create(
-                            std::filesystem::path(modpack->path).filename().string(), "chatFont.fnt", 0.52f
-                        )->getLines()[0];
-                        file->setID("file"_spr);
-                        limitNodeWidth(file, 226.000f, file->getScale(), 0.1f);
-                        file->setAnchorPoint(CCPointMake(0.f, -0.15f));
-                        menu->addChildAtPosition(file, Anchor::TopLeft, { 88.000f, -62.000f }, false);
-
-                        auto about = MDTextArea::create(modpack->about, { 280.f, 198.f});
-                        about->setID("about"_spr);
-                        about->ignoreAnchorPointForPosition(1);
-                        menu->addChildAtPosition(about, Anchor::BottomLeft, { 16.000f, 10.000f }, false);
-
-                        auto is_installed = CCBool::create(true);
-                        popup->setUserObject("is_installed"_spr, is_installed);
-
-                        auto infstream = std::stringstream();
-                        infstream << "##### [EDIT PACK](http://e.ee) [DELETE](http://e.ee)" << std::endl;
-                        if (modpack->include_settings_data) infstream << "### Includes settings data" << std::endl;
-                        if (modpack->include_saved_data) infstream << "### Includes saved data" << std::endl;
-                        infstream << "## Mods list:" << std::endl;
-                        for (auto val : modpack->data["entries"]) {
-                            auto id = val.getKey().value_or("");
-
-                            infstream << fmt::format("\n\n [{0}](mod:{0})", id);
-                            if (val.contains("settings")) infstream << " `[settings]`";
-                            if (val.contains("saved")) infstream << " `[saved_data]`";
-                            infstream << std::endl;
-
-                            if (not Loader::get()->getInstalledMod(id)) is_installed->setValue(false);
-                        }
-
-                        auto inf = MDTextArea::create(infstream.str(), {139.000f, 198.f});
-                        inf->setID("inf"_spr);
-                        inf->ignoreAnchorPointForPosition(1);
-                        menu->addChildAtPosition(inf, Anchor::BottomRight, { -139.000f -1, 10.000f }, false);
-
-                        auto popup_really = popup;
-                        {
-                            typedef TextLinkedButtonWrapper LinkItem;
-                            LinkItem* link; //IntelliSence...
-                            auto popup = inf;
-                            assign_to_link(
-                                "EDIT PACK", [&] {
-                                    MDPopup::create("Pack editing...",
-                                        """" "Pack edit UI is planned, but for now its goes manually. "
-                                        """" "Packs takes their places at mod config folder. "
-                                        "\n" "- \".geode_modlist\" ones is .json text files"
-                                        "\n" "- \".geode_modpack\" ones is .zip archive files"
-                                        "\n"
-                                        "\n" "You can open them using \"Open As\" function in your file manager."
-                                        "\n"
-                                        "\n" "### .geode_modpack tips"
-                                        "\n" "- You can add logo.png or pack.png"
-                                        "\n" "- You can add about.md or README.md"
-                                        "\n"
-                                        "\n" "### .geode_modlist tips"
-                                        "\n" "- You can add logo json key with texture/frame name or.. LINK!)"
-                                        "\n" "```"
-                                        "\n"
-                                        R"({
-    "name": "awful mods",
-    "creator": "me",
-    "logo": "https://images2.imgbox.com/66/b5/erYMNC8O_o.png",
-    "entries": ...
-                                        )"
-                                        "\n" "```"
-                                        , "OK")->show();
-                                }
-                            );
-                            assign_to_link(
-                                "DELETE", [modpack] {
-                                    auto path = (const char*)modpack->path.u8string().c_str();
-                                    auto err = std::remove(path);
-                                    if (err) log::error("remove err{} for {}", err, path);
-                                    NEXT_SETUP_TYPE = "setupForPacksList";
-                                    switchToScene(ModsList::create());
-                                }, modpack
-                            );
-                        };
-                        
-                        auto btn_ref = findFirstChildRecursive<ButtonSprite>(popup, [](CCNode*) { return true; });
-                        btn_ref->setString(is_installed->getValue() ? "Uninstall" : "Install");
-                        btn_ref->setScale(0.825f);
-                        btn_ref->setID("setup_btn_ref"_spr);
-                        auto setup = CCMenuItemExt::createSpriteExtra(
-                            btn_ref, [popup, btn_ref, modpack, is_installed](CCNode*) {
-                                if (is_installed->getValue()) {
-                                    for (auto val : modpack->data["entries"]) {
-                                        auto id = val.getKey().value_or("");
-                                        auto mod = Loader::get()->getInstalledMod(id);
-                                        if (!mod) continue;
-                                        mod->uninstall(val.contains("settings") or val.contains("saved"));
-                                    }
-                                    SHOW_RESTART_BUTTON = true;
-                                }
-                                else {
-                                    popup->removeFromParent();
-                                    installPack(modpack);
-                                };
-                                is_installed->setValue(!is_installed->getValue());
-                                btn_ref->setString(is_installed->getValue() ? "Uninstall" : "Install");
-                            }
-                        );
-                        setup->setID("setup_btn"_spr);
-                        menu->addChildAtPosition(setup, Anchor::TopRight, { -70.000f, -38.000f }, false);
-
-                        handleTouchPriority(popup);
-
-                    }
-                );
-                item->setContentWidth(item->getContentWidth() / 2);
-                item->setAnchorPoint({ 1.f, 0.5f });
-                item->m_scaleMultiplier = 0.95f;
-                menu->addChildAtPosition(item, Anchor::Center, {}, false);
-            }
-            scroll->m_contentLayer->setLayout(RowLayout::create()
-                ->setCrossAxisAlignment(AxisAlignment::End)
-                ->setCrossAxisOverflow(true)
-                ->setGrowCrossAxis(true)
-                ->setAxisReverse(true)
-                ->setGap(-3.f)
-            );
-            scroll->moveToTop();
-
-            static auto last_pos = CCPointMake(0, 0);
-            static auto last_size = CCSizeMake(0, 0);
-            scroll->runAction(CCRepeatForever::create(CCSpawn::create(CallFuncExt::create([scroll] {
-                last_pos = scroll->m_contentLayer->getPosition();
-                last_size = scroll->m_contentLayer->getContentSize();
-                }), CCDelayTime::create(0.1f), nullptr)));
-            if (not last_pos.isZero() and last_size.equals(scroll->m_contentLayer->getContentSize()))
-                scroll->m_contentLayer->setPosition(last_pos);
+            //rows are made once the packs the index has nothing fresh for are read
+            Modpack::readFiles(files, [scroll = Ref<ScrollLayer>(scroll), files](auto read) {
+                if (scroll->getParent()) fillPacksList(scroll, files, std::move(read));
+                });
         }
 
         if (auto wiwi = this->querySelector("list-actions-menu")) wiwi->setVisible(!wiwi->m_bVisible);
@@ -1261,35 +1804,43 @@ public:
         if (ModpackCreator::MENU) this->addChild(ModpackCreator::MENU);
 
         if (auto status_bg = this->querySelector("mod-list-frame > ModsStatusNode > status-bg")) {
-            status_bg->runAction(CCRepeatForever::create(CCSpawn::create(CallFuncExt::create([status_bg]
-                {
-                    if (!status_bg) return;
+            //checked every frame, labels are touched only when the status changed since the last draw
+            status_bg->runAction(CCRepeatForever::create(CCSpawn::create(CallFuncExt::create(
+                [status_bg, drawn = ~0ull, was_active = false]() mutable {
+                    auto& status = ModsLayer::status();
+                    if (!status_bg or drawn == status.version()) return;
+                    drawn = status.version();
+
                     if (auto pModsStatusNode = status_bg->getParent()) {
                         auto restart_button = pModsStatusNode->querySelector("restart-button");
-                        if (SHOW_RESTART_BUTTON) {
-                            restart_button->setVisible(SHOW_RESTART_BUTTON);
+                        if (status.restart() and restart_button and !restart_button->isVisible()) {
+                            restart_button->setVisible(true);
                             restart_button->getParent()->updateLayout();
                         }
                     }
-                    if (HIDE_STATUS) {
-                        HIDE_STATUS = !HIDE_STATUS;
-                        status_bg->setVisible(HIDE_STATUS);
+                    //the node shows geode's own status too, hide it only once our jobs are done
+                    if (!status.active()) {
+                        if (was_active) status_bg->setVisible(false);
+                        was_active = false;
+                        return;
                     }
-                    if (not STATUS_TITLE.empty()) {
-                        status_bg->setVisible(true);
-                        for (auto id : STATUS_SHOW_LIST) if (auto a = status_bg->querySelector(id)) {
-                            a->setVisible(true);
-                        }
-                        if (auto aw = typeinfo_cast<CCLabelBMFont*>(status_bg->querySelector("status-label"))) {
-                            if (aw->getString() != STATUS_TITLE) aw->setString(STATUS_TITLE.c_str());
-                            limitNodeSize(aw, CCSizeMake(416, 32.5), 1.f, 0.1f);
-                        }
-                        if (auto aw = typeinfo_cast<CCLabelBMFont*>(status_bg->querySelector("status-percentage-label"))) {
-                            if (aw->getString() != STATUS_PERCENTAGE) aw->setString(STATUS_PERCENTAGE.c_str());
-                        }
+                    was_active = true;
+
+                    auto job = status.current();
+                    status_bg->setVisible(true);
+                    for (auto id : STATUS_SHOW_LIST) if (auto a = status_bg->querySelector(id)) {
+                        a->setVisible(true);
+                    }
+                    if (auto aw = typeinfo_cast<CCLabelBMFont*>(status_bg->querySelector("status-label"))) {
+                        if (aw->getString() != job->title) aw->setString(job->title.c_str());
+                        limitNodeSize(aw, CCSizeMake(416, 32.5), 1.f, 0.1f);
+                    }
+                    if (auto aw = typeinfo_cast<CCLabelBMFont*>(status_bg->querySelector("status-percentage-label"))) {
+                        auto percentage = statusPercentage(job);
+                        if (aw->getString() != percentage) aw->setString(percentage.c_str());
                     }
                 }
-            ), CCDelayTime::create(0.1f), nullptr)));
+            ), nullptr)));
         }
 
         if (NEXT_SETUP_TYPE.size()) {
@@ -1338,8 +1889,9 @@ class $modify(ModpackAutoInstall, MenuLayer) {
     static auto loadit(std::string file, CCScene * scene) {
         file = CCFileUtils::get()->fullPathForFilename(file.c_str(), 0).c_str();
         loadit_pack = new Modpack(file);
-        if (getMod()->getSavedValue<uint32_t>("loadit_hash") == fnv1a_hash(file)) return scene;
-        getMod()->setSavedValue<uint32_t>("loadit_hash", fnv1a_hash(file));
+        auto hash = xxhash::hash_file(file);
+        if (getMod()->getSavedValue<uint64_t>("loadit_hash") == hash) return scene;
+        getMod()->setSavedValue<uint64_t>("loadit_hash", hash);
         ModsLayer::installPack(loadit_pack, true);
         scene = CCScene::create();
 
@@ -1357,9 +1909,12 @@ class $modify(ModpackAutoInstall, MenuLayer) {
 
         auto progress_text = SimpleTextArea::create("");
         scene->runAction(CCRepeatForever::create(CCSpawn::create(CallFuncExt::create(
-            [progress_text = Ref(progress_text)] {
-                if (!progress_text) return;
-                progress_text->setText(ModsLayer::STATUS_TITLE + " " + ModsLayer::STATUS_PERCENTAGE);
+            [progress_text = Ref(progress_text), drawn = ~0ull]() mutable {
+                auto& status = ModsLayer::status();
+                if (!progress_text or drawn == status.version()) return;
+                drawn = status.version();
+                auto job = status.current();
+                progress_text->setText(job ? job->title + " " + ModsLayer::statusPercentage(job) : "");
             }
         ), nullptr)));
         progress_text->setAnchorPoint({ 0.5f, -0.2f });
@@ -1421,4 +1976,16 @@ void modLoaded() {
 
 }
 
-$on_mod(Loaded) { modLoaded(); }
\ No newline at end of file
+$on_mod(Loaded) {
+    perf::trace::name_thread("main");
+
+    //one task pool for creation, installs and pack loading, phones get fewer workers unless asked for more
+    auto workers = (size_t)std::clamp<int64_t>(getMod()->getSettingValue<int64_t>("worker-threads"), 0, 16);
+#ifdef GEODE_IS_MOBILE
+    if (workers == 0) workers = std::min<size_t>(tasks::pool::default_workers(), 2);
+#endif
+    tasks::pool::configure(workers);
+    tasks::main_dispatcher() = [](tasks::task work) { queueInMainThread(std::move(work)); };
+
+    modLoaded();
+}
\ No newline at end of file
@@ -0,0 +1,282 @@
+#pragma once
+
+// Phase timing: spans record wall and cpu time plus bytes in/out of a phase or a single entry of it,
+// counters add up. Everything goes into one process wide session that is reported as json, or as
+// a markdown summary of phases and the slowest entries. Recording is a lock and a push, cheap enough
+// to leave on. Spans on other threads are fine, cpu time is the one of the thread a span ends on.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <trace.hpp>
+
+namespace perf {
+
+    // cpu time of the calling thread in seconds
+    inline double thread_cpu_seconds()
+    {
+#if defined(_WIN32)
+        FILETIME creation, exit, kernel, user;
+        if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) return 0;
+        auto ticks = [](const FILETIME& time) { return (static_cast<std::uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime; };
+        return static_cast<double>(ticks(kernel) + ticks(user)) * 1e-7;
+#else
+        timespec now;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0) return 0;
+        return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) * 1e-9;
+#endif
+    }
+
+    struct record
+    {
+        std::string name;           // phase, like "install.extract"
+        std::string detail;         // entry the span was about, empty for whole phases
+        double start = 0;           // seconds since the session started
+        double wall = 0, cpu = 0;   // seconds
+        std::uint64_t bytes_in = 0, bytes_out = 0;
+        unsigned thread = 0;        // small per session thread number
+    };
+
+    struct total
+    {
+        std::size_t count = 0;
+        double wall = 0, cpu = 0;
+        std::uint64_t bytes_in = 0, bytes_out = 0;
+
+        // bytes out per byte in, so compression reads below 1 and extraction above it
+        double ratio() const { return bytes_in ? static_cast<double>(bytes_out) / static_cast<double>(bytes_in) : 0; }
+    };
+
+    class session
+    {
+    public:
+        // records past this are counted but dropped, a pack of thousands of files stays well below it
+        static constexpr std::size_t max_records = 200000;
+
+        static session& get()
+        {
+            static session instance;
+            return instance;
+        }
+
+        double now() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_.load()).count();
+        }
+
+        // starts over, the label names the report
+        void reset(std::string label = {})
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            start_ = std::chrono::steady_clock::now();
+            label_ = std::move(label);
+            records_.clear();
+            counters_.clear();
+            threads_.clear();
+            dropped_ = 0;
+        }
+
+        void add(record entry)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (records_.size() >= max_records)
+            {
+                dropped_++;
+                return;
+            }
+            auto id = std::this_thread::get_id();
+            auto found = threads_.find(id);
+            entry.thread = found != threads_.end() ? found->second : (threads_[id] = static_cast<unsigned>(threads_.size()));
+            records_.push_back(std::move(entry));
+        }
+
+        void count(const std::string& name, double value = 1)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            counters_[name] += value;
+        }
+
+        std::vector<record> records() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return records_;
+        }
+
+        std::map<std::string, total> totals() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::map<std::string, total> out;
+            for (const auto& entry : records_)
+            {
+                auto& sum = out[entry.name];
+                sum.count++;
+                sum.wall += entry.wall;
+                sum.cpu += entry.cpu;
+                sum.bytes_in += entry.bytes_in;
+                sum.bytes_out += entry.bytes_out;
+            }
+            return out;
+        }
+
+        std::string to_json() const
+        {
+            auto records = this->records();
+            auto totals = this->totals();
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            std::string out = "{\"label\":" + quote(label_) + ",\"elapsed\":" + number(now()) + ",\"dropped\":" + std::to_string(dropped_);
+            out += ",\"phases\":{";
+            auto first = true;
+            for (const auto& [name, sum] : totals)
+            {
+                if (!first) out += ',';
+                first = false;
+                out += quote(name) + ":{\"count\":" + std::to_string(sum.count) + ",\"wall\":" + number(sum.wall) + ",\"cpu\":" + number(sum.cpu)
+                    + ",\"bytes_in\":" + std::to_string(sum.bytes_in) + ",\"bytes_out\":" + std::to_string(sum.bytes_out)
+                    + ",\"ratio\":" + number(sum.ratio()) + "}";
+            }
+            out += "},\"counters\":{";
+            first = true;
+            for (const auto& [name, value] : counters_)
+            {
+                if (!first) out += ',';
+                first = false;
+                out += quote(name) + ":" + number(value);
+            }
+            out += "},\"spans\":[";
+            for (std::size_t i = 0; i < records.size(); i++)
+            {
+                const auto& entry = records[i];
+                if (i) out += ',';
+                out += "{\"name\":" + quote(entry.name) + ",\"detail\":" + quote(entry.detail) + ",\"thread\":" + std::to_string(entry.thread)
+                    + ",\"start\":" + number(entry.start) + ",\"wall\":" + number(entry.wall) + ",\"cpu\":" + number(entry.cpu)
+                    + ",\"bytes_in\":" + std::to_string(entry.bytes_in) + ",\"bytes_out\":" + std::to_string(entry.bytes_out) + "}";
+            }
+            out += "]}";
+            return out;
+        }
+
+        // markdown: a line per phase, then the slowest entries. phase wall time is the sum of its spans,
+        // so throughput of a phase running on several threads reads per thread
+        std::string summary(std::size_t slowest = 10) const
+        {
+            std::string out = "### Phases\n";
+            for (const auto& [name, sum] : totals())
+            {
+                out += "- **" + name + "** " + (sum.count > 1 ? std::to_string(sum.count) + "x, " : "") + seconds(sum.wall) + " wall, " + seconds(sum.cpu) + " cpu";
+                if (sum.bytes_in) out += ", " + size(sum.bytes_in) + " in";
+                if (sum.bytes_out) out += ", " + size(sum.bytes_out) + " out";
+                if (sum.bytes_in && sum.bytes_out) out += " (" + number(sum.ratio(), "%.2f") + "x)";
+                auto bytes = std::max(sum.bytes_in, sum.bytes_out);
+                if (bytes && sum.wall > 0) out += ", " + size(static_cast<std::uint64_t>(static_cast<double>(bytes) / sum.wall)) + "/s";
+                out += "\n";
+            }
+
+            auto records = this->records();
+            records.erase(std::remove_if(records.begin(), records.end(), [](const record& entry) { return entry.detail.empty(); }), records.end());
+            auto shown = std::min(slowest, records.size());
+            std::partial_sort(records.begin(), records.begin() + static_cast<std::ptrdiff_t>(shown), records.end(), [](const record& a, const record& b) {
+                return a.wall > b.wall;
+            });
+            if (shown) out += "### Slowest entries\n";
+            for (std::size_t i = 0; i < shown; i++)
+            {
+                out += "- " + records[i].detail + " (" + records[i].name + ") " + seconds(records[i].wall);
+                if (records[i].bytes_in || records[i].bytes_out) out += ", " + size(std::max(records[i].bytes_in, records[i].bytes_out));
+                out += "\n";
+            }
+            return out;
+        }
+
+    private:
+        session() : start_(std::chrono::steady_clock::now()) {}
+
+        static std::string number(double value, const char* format = "%.6g") { return detail::number(value, format); }
+        static std::string quote(const std::string& text) { return detail::quote(text); }
+
+        static std::string seconds(double value)
+        {
+            return value >= 1 ? number(value, "%.2f s") : number(value * 1e3, "%.1f ms");
+        }
+
+        static std::string size(std::uint64_t bytes)
+        {
+            if (bytes >= (1ull << 20)) return number(static_cast<double>(bytes) / (1 << 20), "%.1f MiB");
+            if (bytes >= (1ull << 10)) return number(static_cast<double>(bytes) / (1 << 10), "%.1f KiB");
+            return std::to_string(bytes) + " B";
+        }
+
+        std::atomic<std::chrono::steady_clock::time_point> start_;
+        std::string label_;
+        std::vector<record> records_;
+        std::map<std::string, double> counters_;
+        std::map<std::thread::id, unsigned> threads_;
+        std::size_t dropped_ = 0;
+        mutable std::mutex mutex_;
+    };
+
+    // times from construction to finish() or destruction, and goes into the trace too when one is recording
+    class span
+    {
+    public:
+        explicit span(std::string name, std::string detail = {})
+        {
+            entry_.name = std::move(name);
+            entry_.detail = std::move(detail);
+            entry_.start = session::get().now();
+            cpu_start_ = thread_cpu_seconds();
+            if (trace::enabled()) trace_start_ = trace::now();
+        }
+
+        span(const span&) = delete;
+        span& operator=(const span&) = delete;
+
+        ~span() { finish(); }
+
+        void rename(std::string name) { entry_.name = std::move(name); }
+        void bytes(std::uint64_t in, std::uint64_t out)
+        {
+            entry_.bytes_in = in;
+            entry_.bytes_out = out;
+        }
+        void bytes_in(std::uint64_t in) { entry_.bytes_in = in; }
+        void bytes_out(std::uint64_t out) { entry_.bytes_out = out; }
+
+        void finish()
+        {
+            if (finished_) return;
+            finished_ = true;
+            entry_.wall = session::get().now() - entry_.start;
+            entry_.cpu = thread_cpu_seconds() - cpu_start_;
+            if (trace_start_ >= 0) trace::complete(entry_.name, entry_.detail, trace_start_, trace::now() - trace_start_);
+            session::get().add(std::move(entry_));
+        }
+
+    private:
+        record entry_;
+        double cpu_start_ = 0;
+        double trace_start_ = -1;
+        bool finished_ = false;
+    };
+
+} // namespace perf
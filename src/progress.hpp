@@ -0,0 +1,218 @@
+#pragma once
+
+// Progress of background work for the ui. Any thread pushes updates into a channel without locking,
+// the ui thread drains it into a status once per frame and redraws only when the version moved.
+// Updates carry the whole state of their job, so a drain keeps only what the latest ones say.
+// log_ring keeps the last lines a job logged for a ui that shows them as they come.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace progress {
+
+    struct update
+    {
+        std::string job;            // jobs run side by side, each with its own title and progress
+        std::string title;          // empty keeps the job's title
+        double fraction = 0;        // 0 to 1
+        bool finished = false;      // the job leaves the status
+        bool restart = false;       // something needs the game restarted to take effect
+
+        static update finish(std::string job) { return { std::move(job), {}, 1, true, false }; }
+        static update needs_restart() { return { {}, {}, 0, false, true }; }
+    };
+
+    // multiple producers, one consumer: producers swap themselves in as the head, the consumer walks
+    // from the tail. a push in the middle of linking is seen on the next drain
+    class channel
+    {
+    public:
+        channel() : head_(new node()), tail_(head_.load()) {}
+
+        channel(const channel&) = delete;
+        channel& operator=(const channel&) = delete;
+
+        ~channel()
+        {
+            while (tail_)
+            {
+                auto next = tail_->next.load();
+                delete tail_;
+                tail_ = next;
+            }
+        }
+
+        void push(update value)
+        {
+            auto added = new node();
+            added->value = std::move(value);
+            auto previous = head_.exchange(added, std::memory_order_acq_rel);
+            previous->next.store(added, std::memory_order_release);
+        }
+
+        // consumer only
+        bool pop(update& out)
+        {
+            auto next = tail_->next.load(std::memory_order_acquire);
+            if (!next) return false;
+            out = std::move(next->value);
+            delete tail_;
+            tail_ = next;
+            return true;
+        }
+
+    private:
+        struct node
+        {
+            std::atomic<node*> next { nullptr };
+            update value;
+        };
+
+        std::atomic<node*> head_;
+        node* tail_;    // already consumed, its next is the first pending update
+    };
+
+    // what the ui shows, owned by the consumer thread
+    class status
+    {
+    public:
+        struct job
+        {
+            std::string title;
+            double fraction = 0;
+            std::uint64_t touched = 0;
+        };
+
+        // applies pending updates, returns true when anything shown changed
+        bool drain(channel& from)
+        {
+            auto before = version_;
+            update next;
+            while (from.pop(next)) apply(std::move(next));
+            return version_ != before;
+        }
+
+        void apply(update next)
+        {
+            if (next.restart && !restart_)
+            {
+                restart_ = true;
+                version_++;
+            }
+            if (next.job.empty()) return;
+
+            if (next.finished)
+            {
+                if (jobs_.erase(next.job)) version_++;
+                return;
+            }
+
+            auto& job = jobs_[next.job];
+            auto title = next.title.empty() ? job.title : std::move(next.title);
+            if (job.touched && title == job.title && next.fraction == job.fraction) return;
+            job.title = std::move(title);
+            job.fraction = next.fraction;
+            job.touched = ++touches_;
+            version_++;
+        }
+
+        // bumps on every change, compare with the last one drawn
+        std::uint64_t version() const { return version_; }
+
+        bool active() const { return !jobs_.empty(); }
+        bool restart() const { return restart_; }
+
+        // the job updated last, null when nothing runs
+        const job* current() const
+        {
+            const job* out = nullptr;
+            for (const auto& [_, job] : jobs_)
+            {
+                if (!out || job.touched > out->touched) out = &job;
+            }
+            return out;
+        }
+
+        const std::map<std::string, job>& jobs() const { return jobs_; }
+
+    private:
+        std::map<std::string, job> jobs_;
+        std::uint64_t version_ = 0;
+        std::uint64_t touches_ = 0;
+        bool restart_ = false;
+    };
+
+    // fixed number of the latest lines, written from any thread. the sequence moves on every change,
+    // so a ui polling it redraws only when there is something new, and only what fits its window
+    class log_ring
+    {
+    public:
+        struct snapshot
+        {
+            std::vector<std::string> lines;     // oldest first
+            std::uint64_t dropped = 0;          // lines before them that were pushed out or not asked for
+            std::string footer;
+            std::uint64_t sequence = 0;
+        };
+
+        explicit log_ring(std::size_t capacity = 256) : lines_(capacity ? capacity : 1) {}
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            first_ = 0;
+            count_ = 0;
+            total_ = 0;
+            footer_.clear();
+            sequence_++;
+        }
+
+        void push(std::string line)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            lines_[(first_ + count_) % lines_.size()] = std::move(line);
+            if (count_ < lines_.size()) count_++;
+            else first_ = (first_ + 1) % lines_.size();
+            total_++;
+            sequence_++;
+        }
+
+        // shown after the lines, for the result of the job
+        void set_footer(std::string text)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            footer_ = std::move(text);
+            sequence_++;
+        }
+
+        std::uint64_t sequence() const { return sequence_.load(std::memory_order_acquire); }
+
+        snapshot tail(std::size_t count) const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            snapshot out;
+            auto shown = std::min(count, count_);
+            out.lines.reserve(shown);
+            for (auto i = count_ - shown; i < count_; i++) out.lines.push_back(lines_[(first_ + i) % lines_.size()]);
+            out.dropped = total_ - shown;
+            out.footer = footer_;
+            out.sequence = sequence_.load(std::memory_order_relaxed);
+            return out;
+        }
+
+    private:
+        std::vector<std::string> lines_;
+        std::size_t first_ = 0, count_ = 0;
+        std::uint64_t total_ = 0;
+        std::string footer_;
+        std::atomic<std::uint64_t> sequence_ { 0 };
+        mutable std::mutex mutex_;
+    };
+
+} // namespace progress
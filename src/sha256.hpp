@@ -0,0 +1,192 @@
+#pragma once
+
+// SHA-256 (FIPS 180-4), streaming and whole-file helpers.
+// Used where content identity matters (package store keys), xxhash covers the cheap change checks.
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sha256 {
+
+    using digest_t = std::array<uint8_t, 32>;
+
+    namespace detail {
+
+        constexpr uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+        };
+
+        inline uint32_t rotr(uint32_t x, int r)
+        {
+            return (x >> r) | (x << (32 - r));
+        }
+
+        inline uint32_t read32be(const uint8_t* p)
+        {
+            return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+        }
+
+    } // namespace detail
+
+    class sha256
+    {
+    public:
+        sha256()
+        {
+            reset();
+        }
+
+        void reset()
+        {
+            h_ = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+            total_ = 0;
+            buffered_ = 0;
+        }
+
+        void update(const void* data, std::size_t size)
+        {
+            auto p = static_cast<const uint8_t*>(data);
+            auto end = p + size;
+            total_ += size;
+
+            if (buffered_ + size < sizeof(buffer_))
+            {
+                std::memcpy(buffer_ + buffered_, p, size);
+                buffered_ += size;
+                return;
+            }
+
+            if (buffered_)
+            {
+                auto fill = sizeof(buffer_) - buffered_;
+                std::memcpy(buffer_ + buffered_, p, fill);
+                p += fill;
+                block(buffer_);
+                buffered_ = 0;
+            }
+
+            while (end - p >= 64)
+            {
+                block(p);
+                p += 64;
+            }
+
+            buffered_ = static_cast<std::size_t>(end - p);
+            std::memcpy(buffer_, p, buffered_);
+        }
+
+        void update(const std::string& data)
+        {
+            update(data.data(), data.size());
+        }
+
+        void update(const std::vector<uint8_t>& data)
+        {
+            update(data.data(), data.size());
+        }
+
+        // pads a copy of the state, so more data can still be appended afterwards
+        digest_t digest() const
+        {
+            auto copy = *this;
+            uint8_t pad[72] = { 0x80 };
+            auto pad_size = (buffered_ < 56 ? 56 : 120) - buffered_;
+            uint64_t bits = total_ * 8;
+            for (int i = 0; i < 8; i++) pad[pad_size + i] = static_cast<uint8_t>(bits >> (56 - i * 8));
+            copy.update(pad, pad_size + 8);
+
+            digest_t out;
+            for (int i = 0; i < 8; i++)
+            {
+                out[i * 4 + 0] = static_cast<uint8_t>(copy.h_[i] >> 24);
+                out[i * 4 + 1] = static_cast<uint8_t>(copy.h_[i] >> 16);
+                out[i * 4 + 2] = static_cast<uint8_t>(copy.h_[i] >> 8);
+                out[i * 4 + 3] = static_cast<uint8_t>(copy.h_[i]);
+            }
+            return out;
+        }
+
+    private:
+        void block(const uint8_t* p)
+        {
+            using namespace detail;
+
+            uint32_t w[64];
+            for (int i = 0; i < 16; i++) w[i] = read32be(p + i * 4);
+            for (int i = 16; i < 64; i++)
+            {
+                auto s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                auto s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+
+            auto a = h_[0], b = h_[1], c = h_[2], d = h_[3], e = h_[4], f = h_[5], g = h_[6], h = h_[7];
+            for (int i = 0; i < 64; i++)
+            {
+                auto t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+                auto t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                h = g; g = f; f = e; e = d + t1;
+                d = c; c = b; b = a; a = t1 + t2;
+            }
+
+            h_[0] += a; h_[1] += b; h_[2] += c; h_[3] += d;
+            h_[4] += e; h_[5] += f; h_[6] += g; h_[7] += h;
+        }
+
+        std::array<uint32_t, 8> h_;
+        uint64_t total_;
+        uint8_t buffer_[64];
+        std::size_t buffered_;
+    };
+
+    inline std::string to_hex(const digest_t& digest)
+    {
+        constexpr char chars[] = "0123456789abcdef";
+        std::string out;
+        out.reserve(digest.size() * 2);
+        for (auto byte : digest)
+        {
+            out += chars[byte >> 4];
+            out += chars[byte & 15];
+        }
+        return out;
+    }
+
+    inline digest_t hash(const void* data, std::size_t size)
+    {
+        sha256 state;
+        state.update(data, size);
+        return state.digest();
+    }
+
+    // reads the file in large blocks; returns an empty string if it can't be opened
+    inline std::string hash_file(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return "";
+
+        constexpr std::size_t block_size = 1 << 20;
+        std::vector<char> block(block_size);
+
+        sha256 state;
+        while (file)
+        {
+            file.read(block.data(), static_cast<std::streamsize>(block.size()));
+            state.update(block.data(), static_cast<std::size_t>(file.gcount()));
+        }
+        return to_hex(state.digest());
+    }
+
+} // namespace sha256
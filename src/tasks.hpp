@@ -0,0 +1,378 @@
+#pragma once
+
+// One pool of worker threads for all background work. Every worker has a deque per priority, tasks
+// it submits go to its own deques and are taken newest first, idle workers steal the oldest of
+// someone else's. Tasks from other threads go to a shared queue. Higher priorities are always
+// looked for first, so visible ui work passes background creation at the next task boundary.
+// Threads waiting on a group run its queued tasks themselves, a wait never needs a free worker.
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <trace.hpp>
+
+namespace tasks {
+
+    enum class priority
+    {
+        ui,             // something on screen waits for it
+        normal,         // installs and extraction, the user is waiting but watching a progress bar
+        background      // pack creation, fine to take as long as it needs
+    };
+
+    using task = std::function<void()>;
+
+    class pool
+    {
+    public:
+        static constexpr std::size_t priorities = 3;
+
+        // a worker per core but one, the main thread has the last
+        static std::size_t default_workers()
+        {
+            auto cores = std::thread::hardware_concurrency();
+            return cores > 1 ? cores - 1 : 1;
+        }
+
+        explicit pool(std::size_t workers = 0)
+        {
+            if (workers == 0) workers = default_workers();
+            for (std::size_t i = 0; i < workers; i++) queues_.push_back(std::make_unique<queue>());
+            for (std::size_t i = 0; i < workers; i++)
+            {
+                threads_.emplace_back([this, i] {
+                    current() = { this, i };
+                    perf::trace::name_thread("worker " + std::to_string(i));
+                    work(i);
+                });
+            }
+        }
+
+        pool(const pool&) = delete;
+        pool& operator=(const pool&) = delete;
+
+        // tasks not started by then are dropped
+        ~pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+            for (auto& thread : threads_) thread.join();
+        }
+
+        // the pool of the process, made on first use with the workers configure() asked for
+        static pool& shared()
+        {
+            // never destroyed, at exit a worker may still be in the middle of something
+            static pool* instance = new pool(configured());
+            return *instance;
+        }
+
+        // caps the shared pool's workers, 0 for default_workers(). only before its first use
+        static void configure(std::size_t workers) { configured() = workers; }
+
+        std::size_t size() const { return queues_.size(); }
+
+        void submit(task work, priority level = priority::normal)
+        {
+            auto index = static_cast<std::size_t>(level);
+            auto [owner, self] = current();
+            if (owner == this)
+            {
+                std::lock_guard<std::mutex> lock(queues_[self]->mutex);
+                queues_[self]->tasks[index].push_back(std::move(work));
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lock(shared_mutex_);
+                shared_[index].push_back(std::move(work));
+            }
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex_);
+                pending_++;
+            }
+            wake_.notify_one();
+        }
+
+    private:
+        struct queue
+        {
+            std::mutex mutex;
+            std::array<std::deque<task>, priorities> tasks;
+        };
+
+        struct worker_of
+        {
+            pool* owner = nullptr;
+            std::size_t index = 0;
+        };
+
+        static worker_of& current()
+        {
+            thread_local worker_of instance;
+            return instance;
+        }
+
+        static std::size_t& configured()
+        {
+            static std::size_t workers = 0;
+            return workers;
+        }
+
+        // own newest, then shared oldest, then the oldest of another worker, a priority at a time
+        bool take(std::size_t self, task& out)
+        {
+            for (std::size_t level = 0; level < priorities; level++)
+            {
+                if (self < size())
+                {
+                    auto& own = *queues_[self];
+                    std::lock_guard<std::mutex> lock(own.mutex);
+                    if (!own.tasks[level].empty())
+                    {
+                        out = std::move(own.tasks[level].back());
+                        own.tasks[level].pop_back();
+                        return taken();
+                    }
+                }
+                {
+                    std::lock_guard<std::mutex> lock(shared_mutex_);
+                    if (!shared_[level].empty())
+                    {
+                        out = std::move(shared_[level].front());
+                        shared_[level].pop_front();
+                        return taken();
+                    }
+                }
+                for (std::size_t i = 1; i <= size(); i++)
+                {
+                    auto victim = (self + i) % size();
+                    if (victim == self) continue;
+                    auto& other = *queues_[victim];
+                    std::lock_guard<std::mutex> lock(other.mutex);
+                    if (!other.tasks[level].empty())
+                    {
+                        out = std::move(other.tasks[level].front());
+                        other.tasks[level].pop_front();
+                        return taken();
+                    }
+                }
+            }
+            return false;
+        }
+
+        bool taken()
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            pending_--;
+            return true;
+        }
+
+        // tasks report their own errors, one that throws anyway must not take the worker with it
+        static void run(task& work)
+        {
+            try
+            {
+                work();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        void work(std::size_t self)
+        {
+            while (true)
+            {
+                task next;
+                if (take(self, next))
+                {
+                    run(next);
+                    continue;
+                }
+                // pending counts tasks not taken yet, one pushed right after a failed take is seen here
+                std::unique_lock<std::mutex> lock(sleep_mutex_);
+                wake_.wait(lock, [this] { return stopping_ || pending_ > 0; });
+                if (stopping_) return;
+            }
+        }
+
+        std::vector<std::unique_ptr<queue>> queues_;
+        std::array<std::deque<task>, priorities> shared_;
+        std::mutex shared_mutex_;
+        std::vector<std::thread> threads_;
+        std::mutex sleep_mutex_;
+        std::condition_variable wake_;
+        std::size_t pending_ = 0;
+        bool stopping_ = false;
+    };
+
+    // tasks that are waited for together. at most limit of them run on the pool at once, each as a
+    // pool task of its own so other work of a higher priority gets in between. wait() runs the ones
+    // not started yet on the calling thread and rethrows the first exception any of them threw
+    class group
+    {
+    public:
+        explicit group(priority level = priority::normal, std::size_t limit = 0, pool& on = pool::shared())
+            : state_(std::make_shared<state>())
+        {
+            state_->pool = &on;
+            state_->level = level;
+            state_->limit = limit ? limit : on.size();
+        }
+
+        group(const group&) = delete;
+        group& operator=(const group&) = delete;
+
+        ~group()
+        {
+            try
+            {
+                wait();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        void run(task work)
+        {
+            auto start = false;
+            {
+                std::lock_guard<std::mutex> lock(state_->mutex);
+                state_->queued.push_back(std::move(work));
+                state_->unfinished++;
+                if (state_->runners < state_->limit)
+                {
+                    state_->runners++;
+                    start = true;
+                }
+            }
+            if (start) state::submit_runner(state_);
+        }
+
+        // runs a task of the group that didn't start yet on the calling thread, false when none is left
+        bool run_one()
+        {
+            task work;
+            {
+                std::lock_guard<std::mutex> lock(state_->mutex);
+                if (state_->queued.empty()) return false;
+                work = std::move(state_->queued.front());
+                state_->queued.pop_front();
+            }
+            state_->execute(work);
+            return true;
+        }
+
+        void wait()
+        {
+            while (run_one())
+            {
+            }
+            std::unique_lock<std::mutex> lock(state_->mutex);
+            state_->done.wait(lock, [this] { return state_->unfinished == 0; });
+            if (auto error = std::exchange(state_->error, nullptr)) std::rethrow_exception(error);
+        }
+
+    private:
+        // shared with the runners, which can still be queued on the pool after the group is gone
+        struct state
+        {
+            tasks::pool* pool = nullptr;
+            priority level = priority::normal;
+            std::size_t limit = 1;
+            std::mutex mutex;
+            std::condition_variable done;
+            std::deque<task> queued;
+            std::size_t runners = 0, unfinished = 0;
+            std::exception_ptr error;
+
+            void execute(task& work)
+            {
+                std::exception_ptr thrown;
+                try
+                {
+                    work();
+                }
+                catch (...)
+                {
+                    thrown = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                if (thrown && !error) error = thrown;
+                if (--unfinished == 0) done.notify_all();
+            }
+
+            // a runner takes one task and queues itself again while there are more
+            static void submit_runner(const std::shared_ptr<state>& self)
+            {
+                self->pool->submit([self] {
+                    task work;
+                    {
+                        std::lock_guard<std::mutex> lock(self->mutex);
+                        if (self->queued.empty())
+                        {
+                            self->runners--;
+                            return;
+                        }
+                        work = std::move(self->queued.front());
+                        self->queued.pop_front();
+                    }
+                    self->execute(work);
+                    {
+                        std::lock_guard<std::mutex> lock(self->mutex);
+                        if (self->queued.empty())
+                        {
+                            self->runners--;
+                            return;
+                        }
+                    }
+                    submit_runner(self);
+                }, self->level);
+            }
+        };
+
+        std::shared_ptr<state> state_;
+    };
+
+    // where on_main() sends its callbacks, the mod sets it to the cocos main thread queue.
+    // while it isn't set callbacks run right away on the calling thread
+    inline std::function<void(task)>& main_dispatcher()
+    {
+        static std::function<void(task)> dispatcher;
+        return dispatcher;
+    }
+
+    inline void on_main(task work)
+    {
+        auto& dispatcher = main_dispatcher();
+        if (dispatcher) dispatcher(std::move(work));
+        else work();
+    }
+
+    // runs work on the shared pool, then done with what it returned on the main thread. work must not throw,
+    // it would leave done never called
+    template <class Work, class Done>
+    void run_then_main(priority level, Work work, Done done)
+    {
+        pool::shared().submit([work = std::move(work), done = std::move(done)]() mutable {
+            on_main([result = std::make_shared<decltype(work())>(work()), done = std::move(done)]() mutable {
+                done(std::move(*result));
+            });
+        }, level);
+    }
+
+} // namespace tasks
@@ -0,0 +1,305 @@
+#pragma once
+
+// Timeline recording in Chrome Trace Event json (chrome://tracing, ui.perfetto.dev). Every thread
+// writes events to a buffer of its own without locking, the buffers are read when the trace is saved.
+// While recording is off an event is one relaxed atomic load. Saving is meant for after the traced
+// work, events a thread is writing right then are left out but never torn.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace perf {
+
+    namespace detail {
+
+        inline std::string number(double value, const char* format = "%.6g")
+        {
+            char out[32];
+            std::snprintf(out, sizeof(out), format, value);
+            return out;
+        }
+
+        inline std::string quote(const std::string& text)
+        {
+            std::string out = "\"";
+            for (unsigned char c : text)
+            {
+                if (c == '"' || c == '\\') out += '\\';
+                if (c >= 0x20)
+                {
+                    out += static_cast<char>(c);
+                    continue;
+                }
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            }
+            return out + "\"";
+        }
+
+    } // namespace detail
+
+    namespace trace {
+
+        struct event
+        {
+            std::string name, detail;
+            double start = 0, duration = 0;     // microseconds since the trace started
+            char phase = 'X';                   // X complete, i instant, b/e async begin and end
+            std::uint64_t id = 0;               // async events pair up by it
+        };
+
+        namespace detail {
+
+            // written by its thread only. chunks are published before count, so whatever count says is readable
+            struct buffer
+            {
+                static constexpr std::size_t chunk_size = 1024;
+                static constexpr std::size_t max_chunks = 256;
+
+                std::array<std::atomic<event*>, max_chunks> chunks {};
+                std::atomic_size_t count { 0 };
+                std::atomic_size_t generation { 0 };
+                std::atomic_size_t dropped { 0 };
+                std::atomic_bool alive { true };
+                unsigned thread = 0;
+                std::string name;   // under the registry lock
+
+                ~buffer()
+                {
+                    for (auto& chunk : chunks) delete[] chunk.load();
+                }
+
+                void push(event&& entry, std::size_t current)
+                {
+                    // a new trace started since this thread last wrote, begin from the start
+                    if (generation.load(std::memory_order_relaxed) != current)
+                    {
+                        count.store(0, std::memory_order_relaxed);
+                        dropped.store(0, std::memory_order_relaxed);
+                        generation.store(current, std::memory_order_release);
+                    }
+                    auto index = count.load(std::memory_order_relaxed);
+                    if (index >= chunk_size * max_chunks)
+                    {
+                        dropped.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    }
+                    auto& chunk = chunks[index / chunk_size];
+                    auto* slots = chunk.load(std::memory_order_relaxed);
+                    if (!slots)
+                    {
+                        slots = new event[chunk_size];
+                        chunk.store(slots, std::memory_order_release);
+                    }
+                    slots[index % chunk_size] = std::move(entry);
+                    count.store(index + 1, std::memory_order_release);
+                }
+            };
+
+            struct registry
+            {
+                std::atomic_bool enabled { false };
+                std::atomic_size_t generation { 0 };
+                std::atomic<std::chrono::steady_clock::time_point> epoch { std::chrono::steady_clock::now() };
+                std::mutex mutex;
+                std::vector<std::shared_ptr<buffer>> buffers;
+                unsigned next_thread = 0;
+
+                static registry& get()
+                {
+                    static registry instance;
+                    return instance;
+                }
+            };
+
+            // buffers outlive their threads so worker events are still there when the trace is saved.
+            // a thread gets one on its first event, threads that never record cost nothing
+            struct thread_buffer
+            {
+                std::shared_ptr<buffer> owned;
+                std::string name;
+
+                ~thread_buffer()
+                {
+                    if (owned) owned->alive = false;
+                }
+
+                buffer& get()
+                {
+                    if (!owned)
+                    {
+                        owned = std::make_shared<buffer>();
+                        owned->name = name;
+                        auto& registry = registry::get();
+                        std::lock_guard<std::mutex> lock(registry.mutex);
+                        // finished threads of earlier traces, finished ones of this trace still have events to save
+                        std::erase_if(registry.buffers, [&](const std::shared_ptr<buffer>& buffer) {
+                            return !buffer->alive && buffer->generation != registry.generation;
+                        });
+                        owned->thread = registry.next_thread++;
+                        registry.buffers.push_back(owned);
+                    }
+                    return *owned;
+                }
+            };
+
+            inline thread_buffer& local()
+            {
+                thread_local thread_buffer instance;
+                return instance;
+            }
+
+        } // namespace detail
+
+        inline bool enabled()
+        {
+            return detail::registry::get().enabled.load(std::memory_order_relaxed);
+        }
+
+        // microseconds since start()
+        inline double now()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - detail::registry::get().epoch.load(std::memory_order_relaxed);
+            return std::chrono::duration<double, std::micro>(elapsed).count();
+        }
+
+        // drops what an earlier trace recorded and starts recording
+        inline void start()
+        {
+            auto& registry = detail::registry::get();
+            {
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                std::erase_if(registry.buffers, [](const std::shared_ptr<detail::buffer>& buffer) { return !buffer->alive; });
+            }
+            registry.epoch = std::chrono::steady_clock::now();
+            registry.generation++;
+            registry.enabled = true;
+        }
+
+        inline void stop()
+        {
+            detail::registry::get().enabled = false;
+        }
+
+        inline void emit(event entry)
+        {
+            auto& registry = detail::registry::get();
+            if (!registry.enabled.load(std::memory_order_relaxed)) return;
+            detail::local().get().push(std::move(entry), registry.generation.load(std::memory_order_acquire));
+        }
+
+        inline void complete(std::string name, std::string detail, double start, double duration)
+        {
+            if (!enabled()) return;
+            emit({ std::move(name), std::move(detail), start, duration, 'X', 0 });
+        }
+
+        inline void instant(std::string name, std::string detail = {})
+        {
+            if (!enabled()) return;
+            emit({ std::move(name), std::move(detail), now(), 0, 'i', 0 });
+        }
+
+        // work that isn't bound to a thread (a download), shown on a track of its own
+        inline void async(std::string name, std::string detail, std::uint64_t id, double start, double duration)
+        {
+            if (!enabled()) return;
+            emit({ name, detail, start, 0, 'b', id });
+            emit({ std::move(name), std::move(detail), start + duration, 0, 'e', id });
+        }
+
+        // names the calling thread in the trace viewer
+        inline void name_thread(std::string name)
+        {
+            auto& local = detail::local();
+            local.name = std::move(name);
+            if (!local.owned) return;
+            std::lock_guard<std::mutex> lock(detail::registry::get().mutex);
+            local.owned->name = local.name;
+        }
+
+        inline std::string to_json()
+        {
+            auto& registry = detail::registry::get();
+            std::vector<std::shared_ptr<detail::buffer>> buffers;
+            std::vector<std::string> names;
+            {
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                buffers = registry.buffers;
+                for (const auto& buffer : buffers) names.push_back(buffer->name);
+            }
+            auto generation = registry.generation.load();
+
+            std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+            auto first = true;
+            auto add = [&](const std::string& text) {
+                if (!first) out += ',';
+                first = false;
+                out += text;
+            };
+            std::size_t dropped = 0;
+            for (std::size_t i = 0; i < buffers.size(); i++)
+            {
+                auto& buffer = *buffers[i];
+                if (buffer.generation.load(std::memory_order_acquire) != generation) continue;
+                auto count = buffer.count.load(std::memory_order_acquire);
+                if (!count) continue;
+                dropped += buffer.dropped.load(std::memory_order_relaxed);
+
+                auto thread = std::to_string(buffer.thread);
+                auto name = names[i].empty() ? "thread " + thread : names[i];
+                add("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + thread + ",\"args\":{\"name\":" + perf::detail::quote(name) + "}}");
+
+                for (std::size_t index = 0; index < count; index++)
+                {
+                    const auto& entry = buffer.chunks[index / detail::buffer::chunk_size].load(std::memory_order_acquire)[index % detail::buffer::chunk_size];
+                    auto text = "{\"name\":" + perf::detail::quote(entry.name) + ",\"cat\":\"modpack\",\"ph\":\"" + entry.phase + "\",\"pid\":1,\"tid\":" + thread
+                        + ",\"ts\":" + perf::detail::number(entry.start, "%.3f");
+                    if (entry.phase == 'X') text += ",\"dur\":" + perf::detail::number(entry.duration, "%.3f");
+                    if (entry.phase == 'i') text += ",\"s\":\"t\"";
+                    if (entry.phase == 'b' || entry.phase == 'e') text += ",\"id\":" + std::to_string(entry.id);
+                    if (!entry.detail.empty()) text += ",\"args\":{\"detail\":" + perf::detail::quote(entry.detail) + "}";
+                    add(text + "}");
+                }
+            }
+            out += "],\"otherData\":{\"dropped\":" + std::to_string(dropped) + "}}";
+            return out;
+        }
+
+        // times from construction to destruction when recording, else does nothing
+        class scope
+        {
+        public:
+            explicit scope(const char* name, const std::string& detail = {})
+            {
+                if (!enabled()) return;
+                name_ = name;
+                detail_ = detail;
+                start_ = now();
+            }
+
+            scope(const scope&) = delete;
+            scope& operator=(const scope&) = delete;
+
+            ~scope()
+            {
+                if (name_) complete(name_, std::move(detail_), start_, now() - start_);
+            }
+
+        private:
+            const char* name_ = nullptr;
+            std::string detail_;
+            double start_ = 0;
+        };
+
+    } // namespace trace
+
+} // namespace perf
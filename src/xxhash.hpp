@@ -0,0 +1,216 @@
+#pragma once
+
+// XXH64 (https://github.com/Cyan4973/xxHash), streaming and whole-file helpers.
+// Input is consumed in 32-byte stripes by four independent accumulator lanes, so the four
+// 64-bit multiplies of a stripe overlap in the pipeline instead of waiting on each other.
+// They stay scalar, sse2 and neon have no 64-bit multiply to vectorize them with.
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace xxhash {
+
+    namespace detail {
+
+        constexpr uint64_t prime1 = 11400714785074694791ULL;
+        constexpr uint64_t prime2 = 14029467366897019727ULL;
+        constexpr uint64_t prime3 = 1609587929392839161ULL;
+        constexpr uint64_t prime4 = 9650029242287828579ULL;
+        constexpr uint64_t prime5 = 2870177450012600261ULL;
+
+        inline uint64_t rotl(uint64_t x, int r)
+        {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        inline uint64_t read64(const uint8_t* p)
+        {
+            uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            v = __builtin_bswap64(v);
+#endif
+            return v;
+        }
+
+        inline uint32_t read32(const uint8_t* p)
+        {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            v = __builtin_bswap32(v);
+#endif
+            return v;
+        }
+
+        inline uint64_t round(uint64_t acc, uint64_t input)
+        {
+            acc += input * prime2;
+            acc = rotl(acc, 31);
+            return acc * prime1;
+        }
+
+        inline uint64_t merge_round(uint64_t acc, uint64_t val)
+        {
+            acc ^= round(0, val);
+            return acc * prime1 + prime4;
+        }
+
+    } // namespace detail
+
+    class xxh64
+    {
+    public:
+        explicit xxh64(uint64_t seed = 0)
+        {
+            reset(seed);
+        }
+
+        void reset(uint64_t seed = 0)
+        {
+            seed_ = seed;
+            v1_ = seed + detail::prime1 + detail::prime2;
+            v2_ = seed + detail::prime2;
+            v3_ = seed;
+            v4_ = seed - detail::prime1;
+            total_ = 0;
+            buffered_ = 0;
+        }
+
+        void update(const void* data, std::size_t size)
+        {
+            auto p = static_cast<const uint8_t*>(data);
+            auto end = p + size;
+            total_ += size;
+
+            if (buffered_ + size < sizeof(buffer_))
+            {
+                std::memcpy(buffer_ + buffered_, p, size);
+                buffered_ += size;
+                return;
+            }
+
+            if (buffered_)
+            {
+                auto fill = sizeof(buffer_) - buffered_;
+                std::memcpy(buffer_ + buffered_, p, fill);
+                p += fill;
+                stripe(buffer_);
+                buffered_ = 0;
+            }
+
+            while (end - p >= 32)
+            {
+                stripe(p);
+                p += 32;
+            }
+
+            buffered_ = static_cast<std::size_t>(end - p);
+            std::memcpy(buffer_, p, buffered_);
+        }
+
+        void update(const std::string& data)
+        {
+            update(data.data(), data.size());
+        }
+
+        void update(const std::vector<uint8_t>& data)
+        {
+            update(data.data(), data.size());
+        }
+
+        uint64_t digest() const
+        {
+            using namespace detail;
+
+            uint64_t h;
+            if (total_ >= 32)
+            {
+                h = rotl(v1_, 1) + rotl(v2_, 7) + rotl(v3_, 12) + rotl(v4_, 18);
+                h = merge_round(h, v1_);
+                h = merge_round(h, v2_);
+                h = merge_round(h, v3_);
+                h = merge_round(h, v4_);
+            }
+            else
+            {
+                h = seed_ + prime5;
+            }
+
+            h += total_;
+
+            auto p = buffer_;
+            auto end = buffer_ + buffered_;
+            while (end - p >= 8)
+            {
+                h ^= round(0, read64(p));
+                h = rotl(h, 27) * prime1 + prime4;
+                p += 8;
+            }
+            if (end - p >= 4)
+            {
+                h ^= static_cast<uint64_t>(read32(p)) * prime1;
+                h = rotl(h, 23) * prime2 + prime3;
+                p += 4;
+            }
+            while (p < end)
+            {
+                h ^= (*p) * prime5;
+                h = rotl(h, 11) * prime1;
+                p++;
+            }
+
+            h ^= h >> 33;
+            h *= prime2;
+            h ^= h >> 29;
+            h *= prime3;
+            h ^= h >> 32;
+            return h;
+        }
+
+    private:
+        void stripe(const uint8_t* p)
+        {
+            v1_ = detail::round(v1_, detail::read64(p));
+            v2_ = detail::round(v2_, detail::read64(p + 8));
+            v3_ = detail::round(v3_, detail::read64(p + 16));
+            v4_ = detail::round(v4_, detail::read64(p + 24));
+        }
+
+        uint64_t seed_;
+        uint64_t v1_, v2_, v3_, v4_;
+        uint64_t total_;
+        uint8_t buffer_[32];
+        std::size_t buffered_;
+    };
+
+    inline uint64_t hash(const void* data, std::size_t size, uint64_t seed = 0)
+    {
+        xxh64 state(seed);
+        state.update(data, size);
+        return state.digest();
+    }
+
+    // reads the file in large blocks; returns 0 if it can't be opened
+    inline uint64_t hash_file(const std::filesystem::path& path, uint64_t seed = 0)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return 0;
+
+        constexpr std::size_t block_size = 1 << 20;
+        std::vector<char> block(block_size);
+
+        xxh64 state(seed);
+        while (file)
+        {
+            file.read(block.data(), static_cast<std::streamsize>(block.size()));
+            state.update(block.data(), static_cast<std::size_t>(file.gcount()));
+        }
+        return state.digest();
+    }
+
+} // namespace xxhash
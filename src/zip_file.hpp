@@ -23,16 +23,33 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <fstream>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <time.h>
+#include <unordered_map>
 #include <vector>
 
+#include <perf.hpp>
+#include <tasks.hpp>
+
 /* miniz.c v1.15 - public domain deflate/inflate, zlib-subset, ZIP reading/writing/appending, PNG writing
    See "unlicense" statement at the end of this file.
    Rich Geldreich <richgel99@gmail.com>, last updated Oct. 13, 2013
@@ -282,6 +299,14 @@ extern "C" {
     // mz_crc32() returns the initial CRC-32 value to use when called with ptr==NULL.
     mz_ulong mz_crc32(mz_ulong crc, const unsigned char* ptr, size_t buf_len);
 
+    // CRC-32 kernels behind mz_crc32(). It picks the fastest one the running CPU supports on first use; they all produce identical results.
+    // mz_crc32_with() runs a specific kernel (only valid if mz_crc32_supported() returns non-zero for it), mainly for testing and benchmarks.
+    typedef enum { MZ_CRC32_NIBBLE = 0, MZ_CRC32_SLICE8, MZ_CRC32_PCLMUL, MZ_CRC32_ARMV8, MZ_CRC32_VARIANT_COUNT } mz_crc32_variant;
+    int mz_crc32_supported(mz_crc32_variant variant);
+    mz_crc32_variant mz_crc32_active(void);
+    const char* mz_crc32_name(mz_crc32_variant variant);
+    mz_ulong mz_crc32_with(mz_crc32_variant variant, mz_ulong crc, const unsigned char* ptr, size_t buf_len);
+
     // Compression strategies.
     enum { MZ_DEFAULT_STRATEGY = 0, MZ_FILTERED = 1, MZ_HUFFMAN_ONLY = 2, MZ_RLE = 3, MZ_FIXED = 4 };
 
@@ -684,6 +709,7 @@ extern "C" {
     // Adds the contents of a memory buffer to an archive. These functions record the current local time into the archive.
     // To add a directory entry, call this method with an archive name ending in a forwardslash with empty buffer.
     // level_and_flags - compression level (0-10, see MZ_BEST_SPEED, MZ_BEST_COMPRESSION, etc.) logically OR'd with zero or more mz_zip_flags, or just set to MZ_DEFAULT_COMPRESSION.
+    // With MZ_ZIP_FLAG_COMPRESSED_DATA, pBuf is raw deflate data, or stored data if the level is 0; uncomp_size and uncomp_crc32 must be provided.
     mz_bool mz_zip_writer_add_mem(mz_zip_archive* pZip, const char* pArchive_name, const void* pBuf, size_t buf_size, mz_uint level_and_flags);
     mz_bool mz_zip_writer_add_mem_ex(mz_zip_archive* pZip, const char* pArchive_name, const void* pBuf, size_t buf_size, const void* pComment, mz_uint16 comment_size, mz_uint level_and_flags, mz_uint64 uncomp_size, mz_uint32 uncomp_crc32);
 
@@ -693,6 +719,10 @@ extern "C" {
     mz_bool mz_zip_writer_add_file(mz_zip_archive* pZip, const char* pArchive_name, const char* pSrc_filename, const void* pComment, mz_uint16 comment_size, mz_uint level_and_flags);
 #endif
 
+    // Stores uncomp_size bytes pulled from read_func in MZ_ZIP_MAX_IO_BUF_SIZE chunks, the crc is computed on the way and the local
+    // header patched after the data, so payloads of any size go in without being held in memory. Records the current local time.
+    mz_bool mz_zip_writer_add_read_func_stored(mz_zip_archive* pZip, const char* pArchive_name, mz_file_read_func read_func, void* pOpaque, mz_uint64 uncomp_size);
+
     // Adds a file to an archive by fully cloning the data from another archive.
     // This function fully clones the source file's compressed data (no recompression), along with its full filename, extra data, and comment fields.
     mz_bool mz_zip_writer_add_from_zip_reader(mz_zip_archive* pZip, mz_zip_archive* pSource_zip, mz_uint file_index);
@@ -805,6 +835,21 @@ extern "C" {
 #define TINFL_BITBUF_SIZE (32)
 #endif
 
+// The fast decode loop in tinfl_decompress() needs the 64-bit bit buffer and refills it with a single little-endian load.
+#if TINFL_USE_64BIT_BITBUF && MINIZ_LITTLE_ENDIAN
+#define TINFL_USE_FAST_LOOP 1
+#endif
+
+#if TINFL_USE_FAST_LOOP
+    // Two-level decode tables used by the fast loop. Each entry packs (value << 16) | (extra_bits << 8) | (kind << 4) | code_len; the ENOUGH sizes are
+    // the largest a complete code can need with these root sizes (primary table plus all subtables).
+    enum
+    {
+        TINFL_FAST_LITLEN_BITS = 11, TINFL_FAST_LITLEN_ENOUGH = 2342, TINFL_FAST_DIST_BITS = 8, TINFL_FAST_DIST_ENOUGH = 402,
+        TINFL_FAST_LITERAL = 0, TINFL_FAST_CODED = 1, TINFL_FAST_END_OF_BLOCK = 2, TINFL_FAST_SUBTABLE = 3, TINFL_FAST_INVALID = 4
+    };
+#endif
+
     struct tinfl_decompressor_tag
     {
         mz_uint32 m_state, m_num_bits, m_zhdr0, m_zhdr1, m_z_adler32, m_final, m_type, m_check_adler32, m_dist, m_counter, m_num_extra, m_table_sizes[TINFL_MAX_HUFF_TABLES];
@@ -812,6 +857,9 @@ extern "C" {
         size_t m_dist_from_out_buf_start;
         tinfl_huff_table m_tables[TINFL_MAX_HUFF_TABLES];
         mz_uint8 m_raw_header[4], m_len_codes[TINFL_MAX_HUFF_SYMBOLS_0 + TINFL_MAX_HUFF_SYMBOLS_1 + 137];
+#if TINFL_USE_FAST_LOOP
+        mz_uint32 m_fast_ok, m_fast_litlen[TINFL_FAST_LITLEN_ENOUGH], m_fast_dist[TINFL_FAST_DIST_ENOUGH];
+#endif
     };
 
     // ------------------- Low-level Compression API Definitions
@@ -908,6 +956,13 @@ extern "C" {
         TDEFL_FINISH = 4
     } tdefl_flush;
 
+    // Longest-match kernels behind the compressor's match finder. tdefl_init() picks the fastest one the running CPU supports; they all produce identical compressed streams.
+    // tdefl_set_match_variant() swaps in a specific kernel after tdefl_init() (fails if tdefl_match_supported() returns zero for it), mainly for testing and benchmarks.
+    typedef enum { TDEFL_MATCH_SCALAR = 0, TDEFL_MATCH_SSE2, TDEFL_MATCH_AVX2, TDEFL_MATCH_NEON, TDEFL_MATCH_VARIANT_COUNT } tdefl_match_variant;
+
+    // Returns the length of the common prefix of the two TDEFL_MAX_MATCH_LEN byte windows.
+    typedef mz_uint(*tdefl_match_len_func)(const mz_uint8* pA, const mz_uint8* pB);
+
     // tdefl's compression state structure.
     typedef struct
     {
@@ -926,6 +981,7 @@ extern "C" {
         tdefl_flush m_flush;
         const mz_uint8* m_pSrc;
         size_t m_src_buf_left, m_out_buf_ofs;
+        tdefl_match_len_func m_pMatch_len;
         mz_uint8 m_dict[TDEFL_LZ_DICT_SIZE + TDEFL_MAX_MATCH_LEN - 1];
         mz_uint16 m_huff_count[TDEFL_MAX_HUFF_TABLES][TDEFL_MAX_HUFF_SYMBOLS];
         mz_uint16 m_huff_codes[TDEFL_MAX_HUFF_TABLES][TDEFL_MAX_HUFF_SYMBOLS];
@@ -953,6 +1009,11 @@ extern "C" {
     tdefl_status tdefl_get_prev_return_status(tdefl_compressor* d);
     mz_uint32 tdefl_get_adler32(tdefl_compressor* d);
 
+    int tdefl_match_supported(tdefl_match_variant variant);
+    tdefl_match_variant tdefl_match_active(void);
+    const char* tdefl_match_name(tdefl_match_variant variant);
+    mz_bool tdefl_set_match_variant(tdefl_compressor* d, tdefl_match_variant variant);
+
     // Can't use tdefl_create_comp_flags_from_zip_params if MINIZ_NO_ZLIB_APIS isn't defined, because it uses some of its macros.
 #ifndef MINIZ_NO_ZLIB_APIS
 // Create tdefl_compress() flags given zlib-style compression parameters.
@@ -1003,6 +1064,8 @@ typedef unsigned char mz_validate_uint64[sizeof(mz_uint64) == 8 ? 1 : -1];
 #define MZ_READ_LE32(p) ((mz_uint32)(((const mz_uint8 *)(p))[0]) | ((mz_uint32)(((const mz_uint8 *)(p))[1]) << 8U) | ((mz_uint32)(((const mz_uint8 *)(p))[2]) << 16U) | ((mz_uint32)(((const mz_uint8 *)(p))[3]) << 24U))
 #endif
 
+#define MZ_READ_LE64(p) (((mz_uint64)MZ_READ_LE32(p)) | (((mz_uint64)MZ_READ_LE32((const mz_uint8 *)(p) + sizeof(mz_uint32))) << 32U))
+
 #ifdef _MSC_VER
 #define MZ_FORCEINLINE __forceinline
 #elif defined(__GNUC__)
@@ -1011,6 +1074,57 @@ typedef unsigned char mz_validate_uint64[sizeof(mz_uint64) == 8 ? 1 : -1];
 #define MZ_FORCEINLINE inline
 #endif
 
+#if defined(__GNUC__) || defined(__clang__)
+#define MZ_TARGET(x) __attribute__((target(x)))
+#else
+#define MZ_TARGET(x)
+#endif
+
+// Carry-less multiply CRC-32 folding on x64 (PCLMULQDQ, checked with cpuid at runtime).
+#if defined(__x86_64__) || defined(_M_X64)
+#define MINIZ_CRC32_PCLMUL 1
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// ARMv8 CRC32 instructions on arm64 (optional before ARMv8.1, so also checked at runtime unless the compiler already targets them).
+#if defined(__aarch64__) && defined(__clang__)
+#define MINIZ_CRC32_ARMV8 1
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#elif defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32 (1 << 7)
+#endif
+#endif
+#endif
+
+// Match length compares for tdefl: SSE2 is baseline on x64 and AVX2 is checked with cpuid at runtime, NEON is baseline on arm64.
+#if defined(__x86_64__) || defined(_M_X64)
+#define MINIZ_MATCH_X64 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MINIZ_MATCH_NEON 1
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+static MZ_FORCEINLINE mz_uint mz_ctz32(mz_uint32 v) { unsigned long i; _BitScanForward(&i, v); return (mz_uint)i; }
+#if MINIZ_HAS_64BIT_REGISTERS
+static MZ_FORCEINLINE mz_uint mz_ctz64(mz_uint64 v) { unsigned long i; _BitScanForward64(&i, v); return (mz_uint)i; }
+#endif
+#else
+static MZ_FORCEINLINE mz_uint mz_ctz32(mz_uint32 v) { return (mz_uint)__builtin_ctz(v); }
+static MZ_FORCEINLINE mz_uint mz_ctz64(mz_uint64 v) { return (mz_uint)__builtin_ctzll(v); }
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -1032,15 +1146,215 @@ extern "C" {
         return (s2 << 16) + s1;
     }
 
+    // All kernels below take and return the inverted (running) CRC; mz_crc32() does the pre/post conditioning.
+    typedef mz_uint32(*mz_crc32_kernel)(mz_uint32 crc, const mz_uint8* ptr, size_t buf_len);
+
     // Karl Malbrain's compact CRC-32. See "A compact CCITT crc16 and crc32 C implementation that balances processor cache usage against speed": http://www.geocities.com/malbrain/
-    mz_ulong mz_crc32(mz_ulong crc, const mz_uint8* ptr, size_t buf_len)
+    static mz_uint32 mz_crc32_nibble(mz_uint32 crcu32, const mz_uint8* ptr, size_t buf_len)
     {
         static const mz_uint32 s_crc32[16] = { 0, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
           0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c };
-        mz_uint32 crcu32 = (mz_uint32)crc;
+        while (buf_len--) { mz_uint8 b = *ptr++; crcu32 = (crcu32 >> 4) ^ s_crc32[(crcu32 & 0xF) ^ (b & 0xF)]; crcu32 = (crcu32 >> 4) ^ s_crc32[(crcu32 & 0xF) ^ (b >> 4)]; }
+        return crcu32;
+    }
+
+    // Slicing-by-8 tables: s_table[0] is the classic bytewise table, s_table[k][i] is the CRC of byte i followed by k zero bytes.
+    struct mz_crc32_slice_tables
+    {
+        mz_uint32 s_table[8][256];
+
+        constexpr mz_crc32_slice_tables() : s_table()
+        {
+            for (mz_uint32 i = 0; i < 256; ++i)
+            {
+                mz_uint32 c = i;
+                for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (0xEDB88320U & (0U - (c & 1)));
+                s_table[0][i] = c;
+            }
+            for (mz_uint32 i = 0; i < 256; ++i)
+                for (int k = 1; k < 8; ++k) s_table[k][i] = (s_table[k - 1][i] >> 8) ^ s_table[0][s_table[k - 1][i] & 0xFF];
+        }
+    };
+    static constexpr mz_crc32_slice_tables s_crc32_slices{};
+
+    // Portable baseline: 8 bytes per iteration with 8 independent table lookups.
+    static mz_uint32 mz_crc32_slice8(mz_uint32 crc, const mz_uint8* ptr, size_t buf_len)
+    {
+        const mz_uint32(*t)[256] = s_crc32_slices.s_table;
+        for (; buf_len && ((size_t)ptr & 7); --buf_len) crc = (crc >> 8) ^ t[0][(crc ^ *ptr++) & 0xFF];
+#if MINIZ_LITTLE_ENDIAN
+        for (; buf_len >= 8; buf_len -= 8, ptr += 8)
+        {
+            mz_uint32 lo, hi; memcpy(&lo, ptr, 4); memcpy(&hi, ptr + 4, 4); lo ^= crc;
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        }
+#endif
+        for (; buf_len; --buf_len) crc = (crc >> 8) ^ t[0][(crc ^ *ptr++) & 0xFF];
+        return crc;
+    }
+
+#if MINIZ_CRC32_PCLMUL
+    // Folds 64 bytes per iteration with carry-less multiplies, then Barrett-reduces to 32 bits.
+    // Constants are the bit-reflected ones from Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+    MZ_TARGET("pclmul,sse2") static mz_uint32 mz_crc32_pclmul_fold(mz_uint32 crc, const mz_uint8* ptr, size_t buf_len)
+    {
+        const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+        const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+        const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124LL);
+        const __m128i poly = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+        const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+        __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+        x1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(ptr + 0x00)), _mm_cvtsi32_si128((int)crc));
+        x2 = _mm_loadu_si128((const __m128i*)(ptr + 0x10));
+        x3 = _mm_loadu_si128((const __m128i*)(ptr + 0x20));
+        x4 = _mm_loadu_si128((const __m128i*)(ptr + 0x30));
+        ptr += 64; buf_len -= 64;
+
+        x0 = k1k2;
+        for (; buf_len >= 64; ptr += 64, buf_len -= 64)
+        {
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00); x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x6 = _mm_clmulepi64_si128(x2, x0, 0x00); x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+            x7 = _mm_clmulepi64_si128(x3, x0, 0x00); x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+            x8 = _mm_clmulepi64_si128(x4, x0, 0x00); x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*)(ptr + 0x00)));
+            x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*)(ptr + 0x10)));
+            x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*)(ptr + 0x20)));
+            x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*)(ptr + 0x30)));
+        }
+
+        // Fold the four lanes into one, then any remaining 16 byte blocks.
+        x0 = k3k4;
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00); x1 = _mm_clmulepi64_si128(x1, x0, 0x11); x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00); x1 = _mm_clmulepi64_si128(x1, x0, 0x11); x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00); x1 = _mm_clmulepi64_si128(x1, x0, 0x11); x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+        for (; buf_len >= 16; ptr += 16, buf_len -= 16)
+        {
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00); x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*)ptr));
+        }
+
+        // 128 -> 64 bits.
+        x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+        x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+        x2 = _mm_srli_si128(x1, 4);
+        x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k5k0, 0x00), x2);
+
+        // Barrett reduction to 32 bits.
+        x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x10);
+        x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), poly, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+        return (mz_uint32)_mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+    }
+
+    static mz_uint32 mz_crc32_pclmul(mz_uint32 crc, const mz_uint8* ptr, size_t buf_len)
+    {
+        if (buf_len >= 64)
+        {
+            size_t n = buf_len & ~(size_t)15;
+            crc = mz_crc32_pclmul_fold(crc, ptr, n); ptr += n; buf_len -= n;
+        }
+        return mz_crc32_slice8(crc, ptr, buf_len);
+    }
+
+    static int mz_crc32_has_pclmul(void)
+    {
+#ifdef _MSC_VER
+        int info[4]; __cpuid(info, 1);
+        return (info[2] >> 1) & 1;
+#else
+        unsigned int a, b, c, d;
+        return __get_cpuid(1, &a, &b, &c, &d) ? (int)((c >> 1) & 1) : 0;
+#endif
+    }
+#endif
+
+#if MINIZ_CRC32_ARMV8
+    MZ_TARGET("crc") static mz_uint32 mz_crc32_armv8(mz_uint32 crc, const mz_uint8* ptr, size_t buf_len)
+    {
+        for (; buf_len && ((size_t)ptr & 7); --buf_len) crc = __builtin_arm_crc32b(crc, *ptr++);
+        for (; buf_len >= 32; buf_len -= 32, ptr += 32)
+        {
+            mz_uint64 v[4]; memcpy(v, ptr, sizeof(v));
+            crc = __builtin_arm_crc32d(crc, v[0]); crc = __builtin_arm_crc32d(crc, v[1]);
+            crc = __builtin_arm_crc32d(crc, v[2]); crc = __builtin_arm_crc32d(crc, v[3]);
+        }
+        for (; buf_len >= 8; buf_len -= 8, ptr += 8) { mz_uint64 v; memcpy(&v, ptr, 8); crc = __builtin_arm_crc32d(crc, v); }
+        for (; buf_len; --buf_len) crc = __builtin_arm_crc32b(crc, *ptr++);
+        return crc;
+    }
+
+    static int mz_crc32_has_armv8(void)
+    {
+#if defined(__ARM_FEATURE_CRC32)
+        return 1;
+#elif defined(__APPLE__)
+        int value = 0; size_t size = sizeof(value);
+        return sysctlbyname("hw.optional.armv8_crc32", &value, &size, NULL, 0) == 0 && value;
+#elif defined(__linux__)
+        return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#else
+        return 0;
+#endif
+    }
+#endif
+
+    int mz_crc32_supported(mz_crc32_variant variant)
+    {
+        switch (variant)
+        {
+        case MZ_CRC32_NIBBLE: case MZ_CRC32_SLICE8: return 1;
+#if MINIZ_CRC32_PCLMUL
+        case MZ_CRC32_PCLMUL: { static const int s_has = mz_crc32_has_pclmul(); return s_has; }
+#endif
+#if MINIZ_CRC32_ARMV8
+        case MZ_CRC32_ARMV8: { static const int s_has = mz_crc32_has_armv8(); return s_has; }
+#endif
+        default: return 0;
+        }
+    }
+
+    mz_crc32_variant mz_crc32_active(void)
+    {
+        if (mz_crc32_supported(MZ_CRC32_PCLMUL)) return MZ_CRC32_PCLMUL;
+        if (mz_crc32_supported(MZ_CRC32_ARMV8)) return MZ_CRC32_ARMV8;
+        return MZ_CRC32_SLICE8;
+    }
+
+    const char* mz_crc32_name(mz_crc32_variant variant)
+    {
+        static const char* s_names[MZ_CRC32_VARIANT_COUNT] = { "nibble", "slice8", "pclmul", "armv8" };
+        return ((unsigned)variant < MZ_CRC32_VARIANT_COUNT) ? s_names[variant] : "";
+    }
+
+    static mz_crc32_kernel mz_crc32_kernel_for(mz_crc32_variant variant)
+    {
+        switch (variant)
+        {
+#if MINIZ_CRC32_PCLMUL
+        case MZ_CRC32_PCLMUL: return mz_crc32_pclmul;
+#endif
+#if MINIZ_CRC32_ARMV8
+        case MZ_CRC32_ARMV8: return mz_crc32_armv8;
+#endif
+        case MZ_CRC32_NIBBLE: return mz_crc32_nibble;
+        default: return mz_crc32_slice8;
+        }
+    }
+
+    mz_ulong mz_crc32_with(mz_crc32_variant variant, mz_ulong crc, const mz_uint8* ptr, size_t buf_len)
+    {
+        if (!ptr) return MZ_CRC32_INIT;
+        return ~mz_crc32_kernel_for(variant)(~(mz_uint32)crc, ptr, buf_len);
+    }
+
+    mz_ulong mz_crc32(mz_ulong crc, const mz_uint8* ptr, size_t buf_len)
+    {
+        static const mz_crc32_kernel s_kernel = mz_crc32_kernel_for(mz_crc32_active());
         if (!ptr) return MZ_CRC32_INIT;
-        crcu32 = ~crcu32; while (buf_len--) { mz_uint8 b = *ptr++; crcu32 = (crcu32 >> 4) ^ s_crc32[(crcu32 & 0xF) ^ (b & 0xF)]; crcu32 = (crcu32 >> 4) ^ s_crc32[(crcu32 & 0xF) ^ (b >> 4)]; }
-        return ~crcu32;
+        return ~s_kernel(~(mz_uint32)crc, ptr, buf_len);
     }
 
     void mz_free(void* p)
@@ -1468,6 +1782,169 @@ extern "C" {
     code_len = TINFL_FAST_LOOKUP_BITS; do { temp = (pHuff)->m_tree[~temp + ((bit_buf >> code_len++) & 1)]; } while (temp < 0); \
   } sym = temp; bit_buf >>= code_len; num_bits -= code_len; } MZ_MACRO_END
 
+#if TINFL_USE_FAST_LOOP
+#define TINFL_FAST_ENTRY(value, extra, kind, len) (((mz_uint32)(value) << 16) | ((mz_uint32)(extra) << 8) | ((mz_uint32)(kind) << 4) | (mz_uint32)(len))
+#define TINFL_FAST_KIND(entry) (((entry) >> 4) & 15)
+
+// TINFL_FAST_PUT_LITERALS() drops a literal entry's code bits and writes its one or two bytes. For single literals the byte after it is rewritten with its
+// own value (a select rather than a branch, which would mispredict constantly), since in a wrapping output buffer that byte is still live history.
+#define TINFL_FAST_PUT_LITERALS(entry) do { \
+  mz_uint8 next = ((entry) & (2U << 8)) ? (mz_uint8)((entry) >> 24) : pOut[1]; \
+  bit_buf >>= ((entry) & 15); num_bits -= ((entry) & 15); \
+  pOut[0] = (mz_uint8)((entry) >> 16); pOut[1] = next; pOut += ((entry) >> 8) & 3; } MZ_MACRO_END
+
+// TINFL_FAST_LOOKUP() decodes the next symbol's table entry and drops its code bits. The fast loop guarantees enough bits are already buffered.
+#define TINFL_FAST_LOOKUP(entry, pTable, root_bits) do { \
+  entry = (pTable)[bit_buf & ((1U << (root_bits)) - 1)]; \
+  if (TINFL_FAST_KIND(entry) == TINFL_FAST_SUBTABLE) { \
+    bit_buf >>= (root_bits); num_bits -= (root_bits); \
+    entry = (pTable)[(entry >> 16) + (bit_buf & ((1U << ((entry >> 8) & 31)) - 1))]; \
+  } bit_buf >>= (entry & 15); num_bits -= (entry & 15); } MZ_MACRO_END
+
+    // Builds a fast loop decode table from a block's code sizes: codes up to root_bits long fill the primary table directly, longer ones go through a
+    // subtable hanging off their root_bits prefix. Symbols map to literals/end of block (litlen) or to base + extra bits from pBase/pExtra.
+    // Returns MZ_FALSE if the code doesn't fit in table_size entries, which only malformed code sizes can cause; the block then uses the coroutine path.
+    static mz_bool tinfl_build_fast_table(mz_uint32* pTable, mz_uint table_size, mz_uint root_bits, const mz_uint8* pCode_size, mz_uint num_syms, const int* pBase, const int* pExtra, mz_bool litlen)
+    {
+        mz_uint16 rev_codes[TINFL_MAX_HUFF_SYMBOLS_0]; mz_uint8 sub_bits[1 << TINFL_FAST_LITLEN_BITS];
+        mz_uint i, sym, next_code[17], total_syms[16], root_size = 1U << root_bits, root_mask = root_size - 1, used = root_size;
+        MZ_CLEAR_OBJ(total_syms); memset(sub_bits, 0, root_size);
+        for (i = 0; i < root_size; ++i) pTable[i] = TINFL_FAST_ENTRY(0, 0, TINFL_FAST_INVALID, 0);
+        for (sym = 0; sym < num_syms; ++sym) total_syms[pCode_size[sym]]++;
+        total_syms[0] = 0; next_code[1] = 0;
+        for (i = 1; i <= 15; ++i) next_code[i + 1] = (next_code[i] + total_syms[i]) << 1;
+
+        for (sym = 0; sym < num_syms; ++sym)
+        {
+            mz_uint len = pCode_size[sym], code, rev = 0, l, entry;
+            if (!len) continue;
+            for (code = next_code[len]++, l = len; l > 0; l--, code >>= 1) rev = (rev << 1) | (code & 1);
+            rev_codes[sym] = (mz_uint16)rev;
+            if (len > root_bits) { sub_bits[rev & root_mask] = (mz_uint8)MZ_MAX(sub_bits[rev & root_mask], len - root_bits); continue; }
+            if (litlen && sym < 256) entry = TINFL_FAST_ENTRY(sym, 1, TINFL_FAST_LITERAL, len);
+            else if (litlen && sym == 256) entry = TINFL_FAST_ENTRY(0, 0, TINFL_FAST_END_OF_BLOCK, len);
+            else if (sym - (litlen ? 257 : 0) < (litlen ? 29U : 30U)) entry = TINFL_FAST_ENTRY(pBase[sym - (litlen ? 257 : 0)], pExtra[sym - (litlen ? 257 : 0)], TINFL_FAST_CODED, len);
+            else entry = TINFL_FAST_ENTRY(0, 0, TINFL_FAST_INVALID, len);
+            for (; rev < root_size; rev += (1U << len)) pTable[rev] = entry;
+        }
+
+        for (i = 0; i < root_size; ++i)
+        {
+            mz_uint j, size = 1U << sub_bits[i];
+            if (!sub_bits[i]) continue;
+            if (used + size > table_size) return MZ_FALSE;
+            pTable[i] = TINFL_FAST_ENTRY(used, sub_bits[i], TINFL_FAST_SUBTABLE, root_bits);
+            for (j = 0; j < size; ++j) pTable[used + j] = TINFL_FAST_ENTRY(0, 0, TINFL_FAST_INVALID, 0);
+            used += size;
+        }
+
+        for (sym = 0; sym < num_syms; ++sym)
+        {
+            mz_uint len = pCode_size[sym], rev, sub, size, entry;
+            if (len <= root_bits) continue;
+            sub = pTable[rev_codes[sym] & root_mask]; size = 1U << ((sub >> 8) & 31); len -= root_bits;
+            if (litlen && sym < 256) entry = TINFL_FAST_ENTRY(sym, 1, TINFL_FAST_LITERAL, len);
+            else if (litlen && sym == 256) entry = TINFL_FAST_ENTRY(0, 0, TINFL_FAST_END_OF_BLOCK, len);
+            else if (sym - (litlen ? 257 : 0) < (litlen ? 29U : 30U)) entry = TINFL_FAST_ENTRY(pBase[sym - (litlen ? 257 : 0)], pExtra[sym - (litlen ? 257 : 0)], TINFL_FAST_CODED, len);
+            else entry = TINFL_FAST_ENTRY(0, 0, TINFL_FAST_INVALID, len);
+            for (rev = rev_codes[sym] >> root_bits; rev < size; rev += (1U << len)) pTable[(sub >> 16) + rev] = entry;
+        }
+
+        // Where two literal codes fit in root_bits together, the primary entry emits both at once. Going downwards only ever reads entries not yet paired.
+        for (i = root_size; litlen && i-- > 0; )
+        {
+            mz_uint32 first = pTable[i], second, len = first & 15;
+            if ((TINFL_FAST_KIND(first) != TINFL_FAST_LITERAL) || (len >= root_bits)) continue;
+            second = pTable[i >> len];
+            if ((TINFL_FAST_KIND(second) != TINFL_FAST_LITERAL) || ((second & 15) > root_bits - len)) continue;
+            pTable[i] = TINFL_FAST_ENTRY((first >> 16) | ((second >> 16) << 8), 2, TINFL_FAST_LITERAL, len + (second & 15));
+        }
+        return MZ_TRUE;
+    }
+
+    // Fast path of tinfl_decompress(): while at least 16 input bytes and room for a maximal match (plus copy slack) remain, decodes without any per-symbol
+    // buffer checks. The 64-bit bit buffer is topped up branch-free, which always covers four primary literal entries or a full length/distance pair with
+    // extra bits; symbols come from the two-level tables in one or two lookups (pairs of short literals share one entry) and matches are copied in 16/8
+    // byte strides. Near either buffer edge it hands back to the coroutine path. Returns 256 at end of block, 1 on corrupt data and 0 when an edge is near.
+    static mz_uint32 tinfl_decode_fast(const tinfl_decompressor* r, const mz_uint8** ppIn, const mz_uint8* pIn_end, mz_uint8* pOut_start, mz_uint8** ppOut, mz_uint8* pOut_end, size_t out_buf_size_mask, mz_uint32 decomp_flags, tinfl_bit_buf_t* pBit_buf, mz_uint32* pNum_bits)
+    {
+        const mz_uint8* pIn = *ppIn; mz_uint8* pOut = *ppOut, * pSrc; tinfl_bit_buf_t bit_buf = *pBit_buf; mz_uint32 num_bits = *pNum_bits, dist, result = 0; size_t dist_from_out_start;
+        const mz_uint32* pLitlen = r->m_fast_litlen, * pDist = r->m_fast_dist;
+        while (((pIn_end - pIn) >= 16) && ((pOut_end - pOut) >= (258 + 16 + 8)))
+        {
+            mz_uint32 entry; mz_uint len, extra; mz_uint64 v;
+            memcpy(&v, pIn, 8); bit_buf |= v << num_bits; pIn += (63 - num_bits) >> 3; num_bits |= 56;
+            entry = pLitlen[bit_buf & ((1U << TINFL_FAST_LITLEN_BITS) - 1)];
+            if (TINFL_FAST_KIND(entry) == TINFL_FAST_LITERAL)
+            {
+                // Literal runs: primary literal entries take at most root_bits, so four of them fit in what a refill guarantees.
+                TINFL_FAST_PUT_LITERALS(entry);
+                entry = pLitlen[bit_buf & ((1U << TINFL_FAST_LITLEN_BITS) - 1)];
+                if (TINFL_FAST_KIND(entry) == TINFL_FAST_LITERAL)
+                {
+                    TINFL_FAST_PUT_LITERALS(entry);
+                    entry = pLitlen[bit_buf & ((1U << TINFL_FAST_LITLEN_BITS) - 1)];
+                    if (TINFL_FAST_KIND(entry) == TINFL_FAST_LITERAL)
+                    {
+                        TINFL_FAST_PUT_LITERALS(entry);
+                        entry = pLitlen[bit_buf & ((1U << TINFL_FAST_LITLEN_BITS) - 1)];
+                        if (TINFL_FAST_KIND(entry) == TINFL_FAST_LITERAL) { TINFL_FAST_PUT_LITERALS(entry); continue; }
+                    }
+                }
+                memcpy(&v, pIn, 8); bit_buf |= v << num_bits; pIn += (63 - num_bits) >> 3; num_bits |= 56;
+            }
+            if (TINFL_FAST_KIND(entry) == TINFL_FAST_SUBTABLE)
+            {
+                bit_buf >>= TINFL_FAST_LITLEN_BITS; num_bits -= TINFL_FAST_LITLEN_BITS;
+                entry = pLitlen[(entry >> 16) + (bit_buf & ((1U << ((entry >> 8) & 31)) - 1))];
+            }
+            if (TINFL_FAST_KIND(entry) == TINFL_FAST_LITERAL) { TINFL_FAST_PUT_LITERALS(entry); continue; }
+            bit_buf >>= (entry & 15); num_bits -= (entry & 15);
+            if (TINFL_FAST_KIND(entry) != TINFL_FAST_CODED) { result = (TINFL_FAST_KIND(entry) == TINFL_FAST_END_OF_BLOCK) ? 256 : 1; break; }
+            extra = (entry >> 8) & 31; len = (entry >> 16) + ((mz_uint)bit_buf & ((1U << extra) - 1)); bit_buf >>= extra; num_bits -= extra;
+
+            TINFL_FAST_LOOKUP(entry, pDist, TINFL_FAST_DIST_BITS);
+            if (TINFL_FAST_KIND(entry) != TINFL_FAST_CODED) { result = 1; break; }
+            extra = (entry >> 8) & 31; dist = (entry >> 16) + ((mz_uint)bit_buf & ((1U << extra) - 1)); bit_buf >>= extra; num_bits -= extra;
+
+            dist_from_out_start = pOut - pOut_start;
+            if (decomp_flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF)
+            {
+                // The source is always behind the output here. The strides may overshoot the match by up to 15 bytes, which the slack keeps
+                // inside the buffer and later output overwrites.
+                mz_uint8* pOut_match_end = pOut + len;
+                if (dist > dist_from_out_start) { result = 1; break; }
+                pSrc = pOut - dist;
+                if (dist >= 16) { do { memcpy(pOut, pSrc, 16); pOut += 16; pSrc += 16; } while (pOut < pOut_match_end); }
+                else if (dist == 1) memset(pOut, *pSrc, len);
+                else
+                {
+                    // Short periods: once the first few bytes are out, the pattern repeats at a multiple of dist that is at least 8.
+                    mz_uint period = dist, lead;
+                    while (period < 8) period += dist;
+                    for (lead = period - dist; lead && pOut < pOut_match_end; --lead) *pOut++ = *pSrc++;
+                    pSrc = pOut - period;
+                    while (pOut < pOut_match_end) { memcpy(pOut, pSrc, 8); pOut += 8; pSrc += 8; }
+                }
+                pOut = pOut_match_end;
+            }
+            else
+            {
+                // Bytes past the output in a wrapping buffer are still live history, so copies here are exact.
+                pSrc = pOut_start + ((dist_from_out_start - dist) & out_buf_size_mask);
+                if ((MZ_MAX(pOut, pSrc) + len) > pOut_end)
+                    while (len--) *pOut++ = pOut_start[(dist_from_out_start++ - dist) & out_buf_size_mask];
+                else if ((pSrc + len <= pOut) || (pOut + len <= pSrc)) { memcpy(pOut, pSrc, len); pOut += len; }
+                else while (len--) *pOut++ = *pSrc++;
+            }
+        }
+
+        // The refills may have left look-ahead bits above num_bits; the coroutine path expects them clear.
+        *pBit_buf = bit_buf & ((((tinfl_bit_buf_t)1) << num_bits) - 1); *pNum_bits = num_bits; *ppIn = pIn; *ppOut = pOut;
+        return result;
+    }
+#endif
+
 #ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable : 4334)
@@ -1597,10 +2074,22 @@ extern "C" {
                         }
                         TINFL_MEMCPY(r->m_tables[0].m_code_size, r->m_len_codes, r->m_table_sizes[0]); TINFL_MEMCPY(r->m_tables[1].m_code_size, r->m_len_codes + r->m_table_sizes[0], r->m_table_sizes[1]);
                     }
+#if TINFL_USE_FAST_LOOP
+                    if (r->m_type == 1)
+                        r->m_fast_ok = tinfl_build_fast_table(r->m_fast_dist, TINFL_FAST_DIST_ENOUGH, TINFL_FAST_DIST_BITS, r->m_tables[1].m_code_size, r->m_table_sizes[1], s_dist_base, s_dist_extra, MZ_FALSE);
+                    else if (r->m_type == 0)
+                        r->m_fast_ok &= tinfl_build_fast_table(r->m_fast_litlen, TINFL_FAST_LITLEN_ENOUGH, TINFL_FAST_LITLEN_BITS, r->m_tables[0].m_code_size, r->m_table_sizes[0], s_length_base, s_length_extra, MZ_TRUE);
+#endif
                 }
                 for (; ; )
                 {
                     mz_uint8* pSrc;
+#if TINFL_USE_FAST_LOOP
+                    // Fast path first; counter reports why it stopped: 256 at end of block, 1 on corrupt data, 0 when a buffer edge is near.
+                    counter = r->m_fast_ok ? tinfl_decode_fast(r, &pIn_buf_cur, pIn_buf_end, pOut_buf_start, &pOut_buf_cur, pOut_buf_end, out_buf_size_mask, decomp_flags, &bit_buf, &num_bits) : 0;
+                    if (counter == 256) break;
+                    if (counter == 1) { TINFL_CR_RETURN_FOREVER(54, TINFL_STATUS_FAILED); }
+#endif
                     for (; ; )
                     {
                         if (((pIn_buf_end - pIn_buf_cur) < 4) || ((pOut_buf_end - pOut_buf_cur) < 2))
@@ -1721,6 +2210,9 @@ extern "C" {
         {
             TINFL_SKIP_BITS(32, num_bits & 7); for (counter = 0; counter < 4; ++counter) { mz_uint s; if (num_bits) TINFL_GET_BITS(41, s, 8); else TINFL_GET_BYTE(42, s); r->m_z_adler32 = (r->m_z_adler32 << 8) | s; }
         }
+        // Hand back whole bytes the bit buffer read ahead of the end of the stream.
+        while ((pIn_buf_cur > pIn_buf_next) && (num_bits >= 8)) { --pIn_buf_cur; num_bits -= 8; }
+        bit_buf &= (((tinfl_bit_buf_t)1) << num_bits) - 1;
         TINFL_CR_RETURN_FOREVER(34, TINFL_STATUS_DONE);
         TINFL_CR_FINISH
 
@@ -2316,13 +2808,152 @@ extern "C" {
         return d->m_output_flush_remaining;
     }
 
+    // All kernels read exactly TDEFL_MAX_MATCH_LEN bytes from each side, which m_dict always has past any position thanks to its mirrored tail.
+    static mz_uint tdefl_match_len_scalar(const mz_uint8* pA, const mz_uint8* pB)
+    {
+        mz_uint len = 0;
+#if MINIZ_HAS_64BIT_REGISTERS && MINIZ_LITTLE_ENDIAN
+        for (; len < 256; len += 8)
+        {
+            mz_uint64 a, b; memcpy(&a, pA + len, 8); memcpy(&b, pB + len, 8);
+            if (a != b) return len + (mz_ctz64(a ^ b) >> 3);
+        }
+#endif
+        while ((len < TDEFL_MAX_MATCH_LEN) && (pA[len] == pB[len])) len++;
+        return len;
+    }
+
+#if MINIZ_MATCH_X64
+    static mz_uint tdefl_match_len_sse2(const mz_uint8* pA, const mz_uint8* pB)
+    {
+        mz_uint len;
+        for (len = 0; len < 256; len += 16)
+        {
+            mz_uint32 diff = (mz_uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(pA + len)), _mm_loadu_si128((const __m128i*)(pB + len)))) ^ 0xFFFFU;
+            if (diff) return len + mz_ctz32(diff);
+        }
+        return (pA[256] != pB[256]) ? 256 : (257 + (pA[257] == pB[257]));
+    }
+
+    MZ_TARGET("avx2") static mz_uint tdefl_match_len_avx2(const mz_uint8* pA, const mz_uint8* pB)
+    {
+        mz_uint len;
+        for (len = 0; len < 256; len += 32)
+        {
+            mz_uint32 diff = ~(mz_uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(pA + len)), _mm256_loadu_si256((const __m256i*)(pB + len))));
+            if (diff) return len + mz_ctz32(diff);
+        }
+        return (pA[256] != pB[256]) ? 256 : (257 + (pA[257] == pB[257]));
+    }
+
+    static int tdefl_match_has_avx2(void)
+    {
+        mz_uint32 xcr0;
+#ifdef _MSC_VER
+        int info[4]; __cpuid(info, 1);
+        if (!((info[2] >> 27) & 1)) return 0; // OSXSAVE
+#if defined(__clang__)
+        { mz_uint32 lo, hi; __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0)); xcr0 = lo; }
+#else
+        xcr0 = (mz_uint32)_xgetbv(0);
+#endif
+        if ((xcr0 & 6) != 6) return 0; // XMM and YMM state saved by the OS
+        __cpuidex(info, 7, 0);
+        return (info[1] >> 5) & 1;
+#else
+        unsigned int a, b, c, d, hi;
+        if (!__get_cpuid(1, &a, &b, &c, &d) || !((c >> 27) & 1)) return 0;
+        __asm__ __volatile__("xgetbv" : "=a"(xcr0), "=d"(hi) : "c"(0));
+        if ((xcr0 & 6) != 6) return 0;
+        return __get_cpuid_count(7, 0, &a, &b, &c, &d) ? (int)((b >> 5) & 1) : 0;
+#endif
+    }
+#endif
+
+#if MINIZ_MATCH_NEON
+    static mz_uint tdefl_match_len_neon(const mz_uint8* pA, const mz_uint8* pB)
+    {
+        mz_uint len;
+        for (len = 0; len < 256; len += 16)
+        {
+            // Narrow the byte compare to 4 bits per lane so it fits a 64-bit scalar.
+            uint8x16_t eq = vceqq_u8(vld1q_u8(pA + len), vld1q_u8(pB + len));
+            mz_uint64 diff = ~vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+            if (diff) return len + (mz_ctz64(diff) >> 2);
+        }
+        return (pA[256] != pB[256]) ? 256 : (257 + (pA[257] == pB[257]));
+    }
+#endif
+
+    int tdefl_match_supported(tdefl_match_variant variant)
+    {
+        switch (variant)
+        {
+        case TDEFL_MATCH_SCALAR: return 1;
+#if MINIZ_MATCH_X64
+        case TDEFL_MATCH_SSE2: return 1;
+        case TDEFL_MATCH_AVX2: { static const int s_has = tdefl_match_has_avx2(); return s_has; }
+#endif
+#if MINIZ_MATCH_NEON
+        case TDEFL_MATCH_NEON: return 1;
+#endif
+        default: return 0;
+        }
+    }
+
+    tdefl_match_variant tdefl_match_active(void)
+    {
+        if (tdefl_match_supported(TDEFL_MATCH_AVX2)) return TDEFL_MATCH_AVX2;
+        if (tdefl_match_supported(TDEFL_MATCH_SSE2)) return TDEFL_MATCH_SSE2;
+        if (tdefl_match_supported(TDEFL_MATCH_NEON)) return TDEFL_MATCH_NEON;
+        return TDEFL_MATCH_SCALAR;
+    }
+
+    const char* tdefl_match_name(tdefl_match_variant variant)
+    {
+        static const char* s_names[TDEFL_MATCH_VARIANT_COUNT] = { "scalar", "sse2", "avx2", "neon" };
+        return ((unsigned)variant < TDEFL_MATCH_VARIANT_COUNT) ? s_names[variant] : "";
+    }
+
+    static tdefl_match_len_func tdefl_match_kernel_for(tdefl_match_variant variant)
+    {
+        switch (variant)
+        {
+#if MINIZ_MATCH_X64
+        case TDEFL_MATCH_SSE2: return tdefl_match_len_sse2;
+        case TDEFL_MATCH_AVX2: return tdefl_match_len_avx2;
+#endif
+#if MINIZ_MATCH_NEON
+        case TDEFL_MATCH_NEON: return tdefl_match_len_neon;
+#endif
+        default: return tdefl_match_len_scalar;
+        }
+    }
+
+    mz_bool tdefl_set_match_variant(tdefl_compressor* d, tdefl_match_variant variant)
+    {
+        if (!d || !tdefl_match_supported(variant)) return MZ_FALSE;
+        d->m_pMatch_len = tdefl_match_kernel_for(variant);
+        return MZ_TRUE;
+    }
+
+    // Most candidates differ within the first few bytes, so settle those inline before paying for the kernel call.
+    static MZ_FORCEINLINE mz_uint tdefl_match_len(tdefl_compressor* d, const mz_uint8* pA, const mz_uint8* pB)
+    {
+#if MINIZ_HAS_64BIT_REGISTERS && MINIZ_LITTLE_ENDIAN
+        mz_uint64 a, b; memcpy(&a, pA, 8); memcpy(&b, pB, 8);
+        if (a != b) return mz_ctz64(a ^ b) >> 3;
+#endif
+        return d->m_pMatch_len(pA, pB);
+    }
+
 #if MINIZ_USE_UNALIGNED_LOADS_AND_STORES
 #define TDEFL_READ_UNALIGNED_WORD(p) *(const mz_uint16*)(p)
     static MZ_FORCEINLINE void tdefl_find_match(tdefl_compressor* d, mz_uint lookahead_pos, mz_uint max_dist, mz_uint max_match_len, mz_uint* pMatch_dist, mz_uint* pMatch_len)
     {
         mz_uint dist, pos = lookahead_pos & TDEFL_LZ_DICT_SIZE_MASK, match_len = *pMatch_len, probe_pos = pos, next_probe_pos, probe_len;
         mz_uint num_probes_left = d->m_max_probes[match_len >= 32];
-        const mz_uint16* s = (const mz_uint16*)(d->m_dict + pos), * p, * q;
+        const mz_uint16* s = (const mz_uint16*)(d->m_dict + pos), * q;
         mz_uint16 c01 = TDEFL_READ_UNALIGNED_WORD(&d->m_dict[pos + match_len - 1]), s01 = TDEFL_READ_UNALIGNED_WORD(s);
         MZ_ASSERT(max_match_len <= TDEFL_MAX_MATCH_LEN); if (max_match_len <= match_len) return;
         for (; ; )
@@ -2337,14 +2968,12 @@ extern "C" {
         if (TDEFL_READ_UNALIGNED_WORD(&d->m_dict[probe_pos + match_len - 1]) == c01) break;
                 TDEFL_PROBE; TDEFL_PROBE; TDEFL_PROBE;
             }
-            if (!dist) break; q = (const mz_uint16*)(d->m_dict + probe_pos); if (TDEFL_READ_UNALIGNED_WORD(q) != s01) continue; p = s; probe_len = 32;
-            do {} while ((TDEFL_READ_UNALIGNED_WORD(++p) == TDEFL_READ_UNALIGNED_WORD(++q)) && (TDEFL_READ_UNALIGNED_WORD(++p) == TDEFL_READ_UNALIGNED_WORD(++q)) &&
-                (TDEFL_READ_UNALIGNED_WORD(++p) == TDEFL_READ_UNALIGNED_WORD(++q)) && (TDEFL_READ_UNALIGNED_WORD(++p) == TDEFL_READ_UNALIGNED_WORD(++q)) && (--probe_len > 0));
-            if (!probe_len)
+            if (!dist) break; q = (const mz_uint16*)(d->m_dict + probe_pos); if (TDEFL_READ_UNALIGNED_WORD(q) != s01) continue;
+            if ((probe_len = tdefl_match_len(d, (const mz_uint8*)s, (const mz_uint8*)q)) == TDEFL_MAX_MATCH_LEN)
             {
                 *pMatch_dist = dist; *pMatch_len = MZ_MIN(max_match_len, TDEFL_MAX_MATCH_LEN); break;
             }
-            else if ((probe_len = ((mz_uint)(p - s) * 2) + (mz_uint)(*(const mz_uint8*)p == *(const mz_uint8*)q)) > match_len)
+            else if (probe_len > match_len)
             {
                 *pMatch_dist = dist; if ((*pMatch_len = match_len = MZ_MIN(max_match_len, probe_len)) == max_match_len) break;
                 c01 = TDEFL_READ_UNALIGNED_WORD(&d->m_dict[pos + match_len - 1]);
@@ -2356,7 +2985,7 @@ extern "C" {
     {
         mz_uint dist, pos = lookahead_pos & TDEFL_LZ_DICT_SIZE_MASK, match_len = *pMatch_len, probe_pos = pos, next_probe_pos, probe_len;
         mz_uint num_probes_left = d->m_max_probes[match_len >= 32];
-        const mz_uint8* s = d->m_dict + pos, * p, * q;
+        const mz_uint8* s = d->m_dict + pos;
         mz_uint8 c0 = d->m_dict[pos + match_len], c1 = d->m_dict[pos + match_len - 1];
         MZ_ASSERT(max_match_len <= TDEFL_MAX_MATCH_LEN); if (max_match_len <= match_len) return;
         for (; ; )
@@ -2371,7 +3000,7 @@ extern "C" {
         if ((d->m_dict[probe_pos + match_len] == c0) && (d->m_dict[probe_pos + match_len - 1] == c1)) break;
                 TDEFL_PROBE; TDEFL_PROBE; TDEFL_PROBE;
             }
-            if (!dist) break; p = s; q = d->m_dict + probe_pos; for (probe_len = 0; probe_len < max_match_len; probe_len++) if (*p++ != *q++) break;
+            if (!dist) break; probe_len = MZ_MIN(tdefl_match_len(d, s, d->m_dict + probe_pos), max_match_len);
             if (probe_len > match_len)
             {
                 *pMatch_dist = dist; if ((*pMatch_len = match_len = probe_len) == max_match_len) return;
@@ -2422,14 +3051,9 @@ extern "C" {
 
                 if (((cur_match_dist = (mz_uint16)(lookahead_pos - probe_pos)) <= dict_size) && ((*(const mz_uint32*)(d->m_dict + (probe_pos &= TDEFL_LZ_DICT_SIZE_MASK)) & 0xFFFFFF) == first_trigram))
                 {
-                    const mz_uint16* p = (const mz_uint16*)pCur_dict;
-                    const mz_uint16* q = (const mz_uint16*)(d->m_dict + probe_pos);
-                    mz_uint32 probe_len = 32;
-                    do {} while ((TDEFL_READ_UNALIGNED_WORD(++p) == TDEFL_READ_UNALIGNED_WORD(++q)) && (TDEFL_READ_UNALIGNED_WORD(++p) == TDEFL_READ_UNALIGNED_WORD(++q)) &&
-                        (TDEFL_READ_UNALIGNED_WORD(++p) == TDEFL_READ_UNALIGNED_WORD(++q)) && (TDEFL_READ_UNALIGNED_WORD(++p) == TDEFL_READ_UNALIGNED_WORD(++q)) && (--probe_len > 0));
-                    cur_match_len = ((mz_uint)(p - (const mz_uint16*)pCur_dict) * 2) + (mz_uint)(*(const mz_uint8*)p == *(const mz_uint8*)q);
-                    if (!probe_len)
-                        cur_match_len = cur_match_dist ? TDEFL_MAX_MATCH_LEN : 0;
+                    cur_match_len = tdefl_match_len(d, pCur_dict, d->m_dict + probe_pos);
+                    if ((cur_match_len == TDEFL_MAX_MATCH_LEN) && (!cur_match_dist))
+                        cur_match_len = 0;
 
                     if ((cur_match_len < TDEFL_MIN_MATCH_LEN) || ((cur_match_len == TDEFL_MIN_MATCH_LEN) && (cur_match_dist >= 8U * 1024U)))
                     {
@@ -2764,6 +3388,7 @@ extern "C" {
         d->m_pIn_buf = NULL; d->m_pOut_buf = NULL;
         d->m_pIn_buf_size = NULL; d->m_pOut_buf_size = NULL;
         d->m_flush = TDEFL_NO_FLUSH; d->m_pSrc = NULL; d->m_src_buf_left = 0; d->m_out_buf_ofs = 0;
+        { static const tdefl_match_len_func s_kernel = tdefl_match_kernel_for(tdefl_match_active()); d->m_pMatch_len = s_kernel; }
         memset(&d->m_huff_count[0][0], 0, sizeof(d->m_huff_count[0][0]) * TDEFL_MAX_HUFF_SYMBOLS_0);
         memset(&d->m_huff_count[1][0], 0, sizeof(d->m_huff_count[1][0]) * TDEFL_MAX_HUFF_SYMBOLS_1);
         return TDEFL_STATUS_OKAY;
@@ -3020,6 +3645,15 @@ extern "C" {
         // End of central directory offsets
         MZ_ZIP_ECDH_SIG_OFS = 0, MZ_ZIP_ECDH_NUM_THIS_DISK_OFS = 4, MZ_ZIP_ECDH_NUM_DISK_CDIR_OFS = 6, MZ_ZIP_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS = 8,
         MZ_ZIP_ECDH_CDIR_TOTAL_ENTRIES_OFS = 10, MZ_ZIP_ECDH_CDIR_SIZE_OFS = 12, MZ_ZIP_ECDH_CDIR_OFS_OFS = 16, MZ_ZIP_ECDH_COMMENT_SIZE_OFS = 20,
+        // Zip64 identifiers and record sizes
+        MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIG = 0x06064b50, MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIG = 0x07064b50, MZ_ZIP64_EXTENDED_INFORMATION_FIELD_HEADER_ID = 0x0001,
+        MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE = 56, MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE = 20, MZ_ZIP64_MAX_EXTRA_FIELD_SIZE = 4 + sizeof(mz_uint64) * 3, MZ_ZIP64_VERSION_NEEDED = 45,
+        // Zip64 end of central directory locator offsets
+        MZ_ZIP64_ECDL_SIG_OFS = 0, MZ_ZIP64_ECDL_NUM_DISK_CDIR_OFS = 4, MZ_ZIP64_ECDL_REL_OFS_TO_ZIP64_ECDR_OFS = 8, MZ_ZIP64_ECDL_TOTAL_NUMBER_OF_DISKS_OFS = 16,
+        // Zip64 end of central directory offsets
+        MZ_ZIP64_ECDH_SIG_OFS = 0, MZ_ZIP64_ECDH_SIZE_OF_RECORD_OFS = 4, MZ_ZIP64_ECDH_VERSION_MADE_BY_OFS = 12, MZ_ZIP64_ECDH_VERSION_NEEDED_OFS = 14,
+        MZ_ZIP64_ECDH_NUM_THIS_DISK_OFS = 16, MZ_ZIP64_ECDH_NUM_DISK_CDIR_OFS = 20, MZ_ZIP64_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS = 24, MZ_ZIP64_ECDH_CDIR_TOTAL_ENTRIES_OFS = 32,
+        MZ_ZIP64_ECDH_CDIR_SIZE_OFS = 40, MZ_ZIP64_ECDH_CDIR_OFS_OFS = 48,
     };
 
     typedef struct
@@ -3221,10 +3855,45 @@ extern "C" {
         }
     }
 
+    // Returns an entry's sizes and local header offset. Fields saturated at 0xFFFFFFFF are taken from the record's Zip64 extended information extra field, which stores only those, in this order.
+    // The record's variable length fields must already be known to lie within the central directory.
+    static mz_bool mz_zip_reader_get_cdh_sizes(const mz_uint8* pCentral_header, mz_uint64* pComp_size, mz_uint64* pUncomp_size, mz_uint64* pLocal_header_ofs)
+    {
+        mz_uint64 comp_size = MZ_READ_LE32(pCentral_header + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS), uncomp_size = MZ_READ_LE32(pCentral_header + MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS);
+        mz_uint64 local_header_ofs = MZ_READ_LE32(pCentral_header + MZ_ZIP_CDH_LOCAL_HEADER_OFS);
+        if ((comp_size == 0xFFFFFFFF) || (uncomp_size == 0xFFFFFFFF) || (local_header_ofs == 0xFFFFFFFF))
+        {
+            const mz_uint8* pExtra = pCentral_header + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + MZ_READ_LE16(pCentral_header + MZ_ZIP_CDH_FILENAME_LEN_OFS);
+            mz_uint extra_remaining = MZ_READ_LE16(pCentral_header + MZ_ZIP_CDH_EXTRA_LEN_OFS);
+            for (; ; )
+            {
+                mz_uint field_id, field_size;
+                if (extra_remaining < 4)
+                    return MZ_FALSE;
+                field_id = MZ_READ_LE16(pExtra); field_size = MZ_READ_LE16(pExtra + 2);
+                if ((field_size + 4) > extra_remaining)
+                    return MZ_FALSE;
+                if (field_id == MZ_ZIP64_EXTENDED_INFORMATION_FIELD_HEADER_ID)
+                {
+                    const mz_uint8* pField = pExtra + 4;
+                    if (uncomp_size == 0xFFFFFFFF) { if (field_size < 8) return MZ_FALSE; uncomp_size = MZ_READ_LE64(pField); pField += 8; field_size -= 8; }
+                    if (comp_size == 0xFFFFFFFF) { if (field_size < 8) return MZ_FALSE; comp_size = MZ_READ_LE64(pField); pField += 8; field_size -= 8; }
+                    if (local_header_ofs == 0xFFFFFFFF) { if (field_size < 8) return MZ_FALSE; local_header_ofs = MZ_READ_LE64(pField); }
+                    break;
+                }
+                pExtra += field_size + 4; extra_remaining -= field_size + 4;
+            }
+        }
+        if (pComp_size) *pComp_size = comp_size;
+        if (pUncomp_size) *pUncomp_size = uncomp_size;
+        if (pLocal_header_ofs) *pLocal_header_ofs = local_header_ofs;
+        return MZ_TRUE;
+    }
+
     static mz_bool mz_zip_reader_read_central_dir(mz_zip_archive* pZip, mz_uint32 flags)
     {
-        mz_uint cdir_size, num_this_disk, cdir_disk_index;
-        mz_uint64 cdir_ofs;
+        mz_uint num_this_disk, cdir_disk_index;
+        mz_uint64 cdir_ofs, cdir_size, total_files, num_entries_on_disk;
         mz_int64 cur_file_ofs;
         const mz_uint8* p;
         mz_uint32 buf_u32[4096 / sizeof(mz_uint32)]; mz_uint8* pBuf = (mz_uint8*)buf_u32;
@@ -3254,20 +3923,52 @@ extern "C" {
         // Read and verify the end of central directory record.
         if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pBuf, MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE) != MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE)
             return MZ_FALSE;
-        if ((MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_SIG_OFS) != MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIG) ||
-            ((pZip->m_total_files = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_CDIR_TOTAL_ENTRIES_OFS)) != MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS)))
+        if (MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_SIG_OFS) != MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIG)
             return MZ_FALSE;
 
         num_this_disk = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_NUM_THIS_DISK_OFS);
         cdir_disk_index = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_NUM_DISK_CDIR_OFS);
+        num_entries_on_disk = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS);
+        total_files = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_CDIR_TOTAL_ENTRIES_OFS);
+        cdir_size = MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_CDIR_SIZE_OFS);
+        cdir_ofs = MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_CDIR_OFS_OFS);
+
+        // Zip64 archives put a locator right before the end of central directory record, pointing at a Zip64 end of central directory record which holds the full width values.
+        if (cur_file_ofs >= (MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE + MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE))
+        {
+            mz_uint64 zip64_end_ofs;
+            if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs - MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE, pBuf, MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE) != MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE)
+                return MZ_FALSE;
+            if (MZ_READ_LE32(pBuf + MZ_ZIP64_ECDL_SIG_OFS) == MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIG)
+            {
+                zip64_end_ofs = MZ_READ_LE64(pBuf + MZ_ZIP64_ECDL_REL_OFS_TO_ZIP64_ECDR_OFS);
+                if (zip64_end_ofs > (mz_uint64)(cur_file_ofs - MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE - MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE))
+                    return MZ_FALSE;
+                if (pZip->m_pRead(pZip->m_pIO_opaque, zip64_end_ofs, pBuf, MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE) != MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE)
+                    return MZ_FALSE;
+                if (MZ_READ_LE32(pBuf + MZ_ZIP64_ECDH_SIG_OFS) != MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIG)
+                    return MZ_FALSE;
+                num_this_disk = MZ_READ_LE32(pBuf + MZ_ZIP64_ECDH_NUM_THIS_DISK_OFS);
+                cdir_disk_index = MZ_READ_LE32(pBuf + MZ_ZIP64_ECDH_NUM_DISK_CDIR_OFS);
+                num_entries_on_disk = MZ_READ_LE64(pBuf + MZ_ZIP64_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS);
+                total_files = MZ_READ_LE64(pBuf + MZ_ZIP64_ECDH_CDIR_TOTAL_ENTRIES_OFS);
+                cdir_size = MZ_READ_LE64(pBuf + MZ_ZIP64_ECDH_CDIR_SIZE_OFS);
+                cdir_ofs = MZ_READ_LE64(pBuf + MZ_ZIP64_ECDH_CDIR_OFS_OFS);
+            }
+        }
+
+        // The central directory is indexed with 32-bit offsets, which caps it (not the archive) at 4GB.
+        if ((total_files != num_entries_on_disk) || (total_files > 0xFFFFFFFF) || (cdir_size > 0xFFFFFFFF))
+            return MZ_FALSE;
+        pZip->m_total_files = (mz_uint)total_files;
+
         if (((num_this_disk | cdir_disk_index) != 0) && ((num_this_disk != 1) || (cdir_disk_index != 1)))
             return MZ_FALSE;
 
-        if ((cdir_size = MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_CDIR_SIZE_OFS)) < pZip->m_total_files * MZ_ZIP_CENTRAL_DIR_HEADER_SIZE)
+        if (cdir_size < total_files * MZ_ZIP_CENTRAL_DIR_HEADER_SIZE)
             return MZ_FALSE;
 
-        cdir_ofs = MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_CDIR_OFS_OFS);
-        if ((cdir_ofs + (mz_uint64)cdir_size) > pZip->m_archive_size)
+        if ((cdir_ofs > pZip->m_archive_size) || (cdir_size > (pZip->m_archive_size - cdir_ofs)))
             return MZ_FALSE;
 
         pZip->m_central_directory_file_ofs = cdir_ofs;
@@ -3277,7 +3978,7 @@ extern "C" {
             mz_uint i, n;
 
             // Read the entire central directory into a heap block, and allocate another heap block to hold the unsorted central dir file record offsets, and another to hold the sorted indices.
-            if ((!mz_zip_array_resize(pZip, &pZip->m_pState->m_central_dir, cdir_size, MZ_FALSE)) ||
+            if ((!mz_zip_array_resize(pZip, &pZip->m_pState->m_central_dir, (size_t)cdir_size, MZ_FALSE)) ||
                 (!mz_zip_array_resize(pZip, &pZip->m_pState->m_central_dir_offsets, pZip->m_total_files, MZ_FALSE)))
                 return MZ_FALSE;
 
@@ -3287,29 +3988,30 @@ extern "C" {
                     return MZ_FALSE;
             }
 
-            if (pZip->m_pRead(pZip->m_pIO_opaque, cdir_ofs, pZip->m_pState->m_central_dir.m_p, cdir_size) != cdir_size)
+            if (pZip->m_pRead(pZip->m_pIO_opaque, cdir_ofs, pZip->m_pState->m_central_dir.m_p, (size_t)cdir_size) != cdir_size)
                 return MZ_FALSE;
 
-            // Now create an index into the central directory file records, do some basic sanity checking on each record, and check for zip64 entries (which are not yet supported).
+            // Now create an index into the central directory file records, and do some basic sanity checking on each record.
             p = (const mz_uint8*)pZip->m_pState->m_central_dir.m_p;
-            for (n = cdir_size, i = 0; i < pZip->m_total_files; ++i)
+            for (n = (mz_uint)cdir_size, i = 0; i < pZip->m_total_files; ++i)
             {
-                mz_uint total_header_size, comp_size, decomp_size, disk_index;
+                mz_uint total_header_size, disk_index;
+                mz_uint64 comp_size, decomp_size, local_header_ofs;
                 if ((n < MZ_ZIP_CENTRAL_DIR_HEADER_SIZE) || (MZ_READ_LE32(p) != MZ_ZIP_CENTRAL_DIR_HEADER_SIG))
                     return MZ_FALSE;
                 MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_central_dir_offsets, mz_uint32, i) = (mz_uint32)(p - (const mz_uint8*)pZip->m_pState->m_central_dir.m_p);
                 if (sort_central_dir)
                     MZ_ZIP_ARRAY_ELEMENT(&pZip->m_pState->m_sorted_central_dir_offsets, mz_uint32, i) = i;
-                comp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS);
-                decomp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS);
-                if (((!MZ_READ_LE32(p + MZ_ZIP_CDH_METHOD_OFS)) && (decomp_size != comp_size)) || (decomp_size && !comp_size) || (decomp_size == 0xFFFFFFFF) || (comp_size == 0xFFFFFFFF))
+                if ((total_header_size = MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS) + MZ_READ_LE16(p + MZ_ZIP_CDH_EXTRA_LEN_OFS) + MZ_READ_LE16(p + MZ_ZIP_CDH_COMMENT_LEN_OFS)) > n)
                     return MZ_FALSE;
-                disk_index = MZ_READ_LE16(p + MZ_ZIP_CDH_DISK_START_OFS);
-                if ((disk_index != num_this_disk) && (disk_index != 1))
+                if (!mz_zip_reader_get_cdh_sizes(p, &comp_size, &decomp_size, &local_header_ofs))
                     return MZ_FALSE;
-                if (((mz_uint64)MZ_READ_LE32(p + MZ_ZIP_CDH_LOCAL_HEADER_OFS) + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + comp_size) > pZip->m_archive_size)
+                if (((!MZ_READ_LE32(p + MZ_ZIP_CDH_METHOD_OFS)) && (decomp_size != comp_size)) || (decomp_size && !comp_size))
                     return MZ_FALSE;
-                if ((total_header_size = MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS) + MZ_READ_LE16(p + MZ_ZIP_CDH_EXTRA_LEN_OFS) + MZ_READ_LE16(p + MZ_ZIP_CDH_COMMENT_LEN_OFS)) > n)
+                disk_index = MZ_READ_LE16(p + MZ_ZIP_CDH_DISK_START_OFS);
+                if ((disk_index != num_this_disk) && (disk_index != 1) && (disk_index != 0xFFFF))
+                    return MZ_FALSE;
+                if ((pZip->m_archive_size < MZ_ZIP_LOCAL_DIR_HEADER_SIZE) || (local_header_ofs > (pZip->m_archive_size - MZ_ZIP_LOCAL_DIR_HEADER_SIZE)) || (comp_size > (pZip->m_archive_size - MZ_ZIP_LOCAL_DIR_HEADER_SIZE - local_header_ofs)))
                     return MZ_FALSE;
                 n -= total_header_size; p += total_header_size;
             }
@@ -3470,11 +4172,10 @@ extern "C" {
         pStat->m_time = mz_zip_dos_to_time_t(MZ_READ_LE16(p + MZ_ZIP_CDH_FILE_TIME_OFS), MZ_READ_LE16(p + MZ_ZIP_CDH_FILE_DATE_OFS));
 #endif
         pStat->m_crc32 = MZ_READ_LE32(p + MZ_ZIP_CDH_CRC32_OFS);
-        pStat->m_comp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS);
-        pStat->m_uncomp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS);
+        if (!mz_zip_reader_get_cdh_sizes(p, &pStat->m_comp_size, &pStat->m_uncomp_size, &pStat->m_local_header_ofs))
+            return MZ_FALSE;
         pStat->m_internal_attr = MZ_READ_LE16(p + MZ_ZIP_CDH_INTERNAL_ATTR_OFS);
         pStat->m_external_attr = MZ_READ_LE32(p + MZ_ZIP_CDH_EXTERNAL_ATTR_OFS);
-        pStat->m_local_header_ofs = MZ_READ_LE32(p + MZ_ZIP_CDH_LOCAL_HEADER_OFS);
 
         // Copy as much of the filename and comment as possible.
         n = MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS); n = MZ_MIN(n, MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE - 1);
@@ -3747,8 +4448,8 @@ extern "C" {
         if (!p)
             return NULL;
 
-        comp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS);
-        uncomp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS);
+        if (!mz_zip_reader_get_cdh_sizes(p, &comp_size, &uncomp_size, NULL))
+            return NULL;
 
         alloc_size = (flags & MZ_ZIP_FLAG_COMPRESSED_DATA) ? comp_size : uncomp_size;
 #ifdef _MSC_VER
@@ -4023,6 +4724,7 @@ extern "C" {
     static void mz_write_le32(mz_uint8* p, mz_uint32 v) { p[0] = (mz_uint8)v; p[1] = (mz_uint8)(v >> 8); p[2] = (mz_uint8)(v >> 16); p[3] = (mz_uint8)(v >> 24); }
 #define MZ_WRITE_LE16(p, v) mz_write_le16((mz_uint8 *)(p), (mz_uint16)(v))
 #define MZ_WRITE_LE32(p, v) mz_write_le32((mz_uint8 *)(p), (mz_uint32)(v))
+#define MZ_WRITE_LE64(p, v) (mz_write_le32((mz_uint8 *)(p), (mz_uint32)(v)), mz_write_le32((mz_uint8 *)(p) + sizeof(mz_uint32), (mz_uint32)((mz_uint64)(v) >> 32U)))
 
     mz_bool mz_zip_writer_init(mz_zip_archive* pZip, mz_uint64 existing_size)
     {
@@ -4143,7 +4845,7 @@ extern "C" {
         if ((!pZip) || (!pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_READING))
             return MZ_FALSE;
         // No sense in trying to write to an archive that's already at the support max size
-        if ((pZip->m_total_files == 0xFFFF) || ((pZip->m_archive_size + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + MZ_ZIP_LOCAL_DIR_HEADER_SIZE) > 0xFFFFFFFF))
+        if (pZip->m_total_files == 0xFFFFFFFF)
             return MZ_FALSE;
 
         pState = pZip->m_pState;
@@ -4209,19 +4911,40 @@ extern "C" {
         return MZ_TRUE;
     }
 
-    static mz_bool mz_zip_writer_create_local_dir_header(mz_zip_archive* pZip, mz_uint8* pDst, mz_uint16 filename_size, mz_uint16 extra_size, mz_uint64 uncomp_size, mz_uint64 comp_size, mz_uint32 uncomp_crc32, mz_uint16 method, mz_uint16 bit_flags, mz_uint16 dos_time, mz_uint16 dos_date)
+    // Deflate may grow incompressible data slightly (stored blocks), so entries close to 4GB get Zip64 local headers too.
+    static MZ_FORCEINLINE mz_bool mz_zip_writer_size_needs_zip64(mz_uint64 size)
+    {
+        return (size + (size >> 12) + 1024) >= 0xFFFFFFFF;
+    }
+
+    // Builds a Zip64 extended information extra field holding the values that are passed in, and returns its size.
+    static mz_uint32 mz_zip_writer_create_zip64_extra_data(mz_uint8* pBuf, const mz_uint64* pUncomp_size, const mz_uint64* pComp_size, const mz_uint64* pLocal_header_ofs)
+    {
+        mz_uint8* pDst = pBuf + 4;
+        if (pUncomp_size) { MZ_WRITE_LE64(pDst, *pUncomp_size); pDst += sizeof(mz_uint64); }
+        if (pComp_size) { MZ_WRITE_LE64(pDst, *pComp_size); pDst += sizeof(mz_uint64); }
+        if (pLocal_header_ofs) { MZ_WRITE_LE64(pDst, *pLocal_header_ofs); pDst += sizeof(mz_uint64); }
+        MZ_WRITE_LE16(pBuf, MZ_ZIP64_EXTENDED_INFORMATION_FIELD_HEADER_ID);
+        MZ_WRITE_LE16(pBuf + 2, (mz_uint32)(pDst - pBuf) - 4);
+        return (mz_uint32)(pDst - pBuf);
+    }
+
+    // With zip64 set, both sizes live in a Zip64 extra field that follows the filename (and is counted in extra_size).
+    static mz_bool mz_zip_writer_create_local_dir_header(mz_zip_archive* pZip, mz_uint8* pDst, mz_uint16 filename_size, mz_uint16 extra_size, mz_uint64 uncomp_size, mz_uint64 comp_size, mz_uint32 uncomp_crc32, mz_uint16 method, mz_uint16 bit_flags, mz_uint16 dos_time, mz_uint16 dos_date, mz_bool zip64)
     {
         (void)pZip;
+        if ((!zip64) && ((uncomp_size >= 0xFFFFFFFF) || (comp_size >= 0xFFFFFFFF)))
+            return MZ_FALSE;
         memset(pDst, 0, MZ_ZIP_LOCAL_DIR_HEADER_SIZE);
         MZ_WRITE_LE32(pDst + MZ_ZIP_LDH_SIG_OFS, MZ_ZIP_LOCAL_DIR_HEADER_SIG);
-        MZ_WRITE_LE16(pDst + MZ_ZIP_LDH_VERSION_NEEDED_OFS, method ? 20 : 0);
+        MZ_WRITE_LE16(pDst + MZ_ZIP_LDH_VERSION_NEEDED_OFS, zip64 ? MZ_ZIP64_VERSION_NEEDED : (method ? 20 : 0));
         MZ_WRITE_LE16(pDst + MZ_ZIP_LDH_BIT_FLAG_OFS, bit_flags);
         MZ_WRITE_LE16(pDst + MZ_ZIP_LDH_METHOD_OFS, method);
         MZ_WRITE_LE16(pDst + MZ_ZIP_LDH_FILE_TIME_OFS, dos_time);
         MZ_WRITE_LE16(pDst + MZ_ZIP_LDH_FILE_DATE_OFS, dos_date);
         MZ_WRITE_LE32(pDst + MZ_ZIP_LDH_CRC32_OFS, uncomp_crc32);
-        MZ_WRITE_LE32(pDst + MZ_ZIP_LDH_COMPRESSED_SIZE_OFS, comp_size);
-        MZ_WRITE_LE32(pDst + MZ_ZIP_LDH_DECOMPRESSED_SIZE_OFS, uncomp_size);
+        MZ_WRITE_LE32(pDst + MZ_ZIP_LDH_COMPRESSED_SIZE_OFS, zip64 ? 0xFFFFFFFF : comp_size);
+        MZ_WRITE_LE32(pDst + MZ_ZIP_LDH_DECOMPRESSED_SIZE_OFS, zip64 ? 0xFFFFFFFF : uncomp_size);
         MZ_WRITE_LE16(pDst + MZ_ZIP_LDH_FILENAME_LEN_OFS, filename_size);
         MZ_WRITE_LE16(pDst + MZ_ZIP_LDH_EXTRA_LEN_OFS, extra_size);
         return MZ_TRUE;
@@ -4229,22 +4952,24 @@ extern "C" {
 
     static mz_bool mz_zip_writer_create_central_dir_header(mz_zip_archive* pZip, mz_uint8* pDst, mz_uint16 filename_size, mz_uint16 extra_size, mz_uint16 comment_size, mz_uint64 uncomp_size, mz_uint64 comp_size, mz_uint32 uncomp_crc32, mz_uint16 method, mz_uint16 bit_flags, mz_uint16 dos_time, mz_uint16 dos_date, mz_uint64 local_header_ofs, mz_uint32 ext_attributes)
     {
+        // Values that don't fit are saturated here and stored in full in the record's Zip64 extra field.
+        mz_bool zip64 = (uncomp_size >= 0xFFFFFFFF) || (comp_size >= 0xFFFFFFFF) || (local_header_ofs >= 0xFFFFFFFF);
         (void)pZip;
         memset(pDst, 0, MZ_ZIP_CENTRAL_DIR_HEADER_SIZE);
         MZ_WRITE_LE32(pDst + MZ_ZIP_CDH_SIG_OFS, MZ_ZIP_CENTRAL_DIR_HEADER_SIG);
-        MZ_WRITE_LE16(pDst + MZ_ZIP_CDH_VERSION_NEEDED_OFS, method ? 20 : 0);
+        MZ_WRITE_LE16(pDst + MZ_ZIP_CDH_VERSION_NEEDED_OFS, zip64 ? MZ_ZIP64_VERSION_NEEDED : (method ? 20 : 0));
         MZ_WRITE_LE16(pDst + MZ_ZIP_CDH_BIT_FLAG_OFS, bit_flags);
         MZ_WRITE_LE16(pDst + MZ_ZIP_CDH_METHOD_OFS, method);
         MZ_WRITE_LE16(pDst + MZ_ZIP_CDH_FILE_TIME_OFS, dos_time);
         MZ_WRITE_LE16(pDst + MZ_ZIP_CDH_FILE_DATE_OFS, dos_date);
         MZ_WRITE_LE32(pDst + MZ_ZIP_CDH_CRC32_OFS, uncomp_crc32);
-        MZ_WRITE_LE32(pDst + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS, comp_size);
-        MZ_WRITE_LE32(pDst + MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS, uncomp_size);
+        MZ_WRITE_LE32(pDst + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS, MZ_MIN(comp_size, 0xFFFFFFFF));
+        MZ_WRITE_LE32(pDst + MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS, MZ_MIN(uncomp_size, 0xFFFFFFFF));
         MZ_WRITE_LE16(pDst + MZ_ZIP_CDH_FILENAME_LEN_OFS, filename_size);
         MZ_WRITE_LE16(pDst + MZ_ZIP_CDH_EXTRA_LEN_OFS, extra_size);
         MZ_WRITE_LE16(pDst + MZ_ZIP_CDH_COMMENT_LEN_OFS, comment_size);
         MZ_WRITE_LE32(pDst + MZ_ZIP_CDH_EXTERNAL_ATTR_OFS, ext_attributes);
-        MZ_WRITE_LE32(pDst + MZ_ZIP_CDH_LOCAL_HEADER_OFS, local_header_ofs);
+        MZ_WRITE_LE32(pDst + MZ_ZIP_CDH_LOCAL_HEADER_OFS, MZ_MIN(local_header_ofs, 0xFFFFFFFF));
         return MZ_TRUE;
     }
 
@@ -4254,16 +4979,25 @@ extern "C" {
         mz_uint32 central_dir_ofs = (mz_uint32)pState->m_central_dir.m_size;
         size_t orig_central_dir_size = pState->m_central_dir.m_size;
         mz_uint8 central_dir_header[MZ_ZIP_CENTRAL_DIR_HEADER_SIZE];
+        mz_uint8 zip64_extra[MZ_ZIP64_MAX_EXTRA_FIELD_SIZE];
+        mz_uint32 zip64_extra_size = 0;
+
+        if ((uncomp_size >= 0xFFFFFFFF) || (comp_size >= 0xFFFFFFFF) || (local_header_ofs >= 0xFFFFFFFF))
+        {
+            zip64_extra_size = mz_zip_writer_create_zip64_extra_data(zip64_extra, (uncomp_size >= 0xFFFFFFFF) ? &uncomp_size : NULL,
+                (comp_size >= 0xFFFFFFFF) ? &comp_size : NULL, (local_header_ofs >= 0xFFFFFFFF) ? &local_header_ofs : NULL);
+        }
 
-        // No zip64 support yet
-        if ((local_header_ofs > 0xFFFFFFFF) || (((mz_uint64)pState->m_central_dir.m_size + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + filename_size + extra_size + comment_size) > 0xFFFFFFFF))
+        // The central directory itself is indexed with 32-bit offsets.
+        if (((extra_size + zip64_extra_size) > 0xFFFF) || (((mz_uint64)pState->m_central_dir.m_size + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + filename_size + zip64_extra_size + extra_size + comment_size) > 0xFFFFFFFF))
             return MZ_FALSE;
 
-        if (!mz_zip_writer_create_central_dir_header(pZip, central_dir_header, filename_size, extra_size, comment_size, uncomp_size, comp_size, uncomp_crc32, method, bit_flags, dos_time, dos_date, local_header_ofs, ext_attributes))
+        if (!mz_zip_writer_create_central_dir_header(pZip, central_dir_header, filename_size, (mz_uint16)(extra_size + zip64_extra_size), comment_size, uncomp_size, comp_size, uncomp_crc32, method, bit_flags, dos_time, dos_date, local_header_ofs, ext_attributes))
             return MZ_FALSE;
 
         if ((!mz_zip_array_push_back(pZip, &pState->m_central_dir, central_dir_header, MZ_ZIP_CENTRAL_DIR_HEADER_SIZE)) ||
             (!mz_zip_array_push_back(pZip, &pState->m_central_dir, pFilename, filename_size)) ||
+            (!mz_zip_array_push_back(pZip, &pState->m_central_dir, zip64_extra, zip64_extra_size)) ||
             (!mz_zip_array_push_back(pZip, &pState->m_central_dir, pExtra, extra_size)) ||
             (!mz_zip_array_push_back(pZip, &pState->m_central_dir, pComment, comment_size)) ||
             (!mz_zip_array_push_back(pZip, &pState->m_central_dir_offsets, &central_dir_ofs, 1)))
@@ -4320,8 +5054,10 @@ extern "C" {
         mz_uint64 local_dir_header_ofs = pZip->m_archive_size, cur_archive_file_ofs = pZip->m_archive_size, comp_size = 0;
         size_t archive_name_size;
         mz_uint8 local_dir_header[MZ_ZIP_LOCAL_DIR_HEADER_SIZE];
+        mz_uint8 local_extra[MZ_ZIP64_MAX_EXTRA_FIELD_SIZE];
+        mz_uint local_extra_size;
         tdefl_compressor* pComp = NULL;
-        mz_bool store_data_uncompressed;
+        mz_bool store_data_uncompressed, zip64;
         mz_zip_internal_state* pState;
 
         if ((int)level_and_flags < 0)
@@ -4329,16 +5065,15 @@ extern "C" {
         level = level_and_flags & 0xF;
         store_data_uncompressed = ((!level) || (level_and_flags & MZ_ZIP_FLAG_COMPRESSED_DATA));
 
-        if ((!pZip) || (!pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_WRITING) || ((buf_size) && (!pBuf)) || (!pArchive_name) || ((comment_size) && (!pComment)) || (pZip->m_total_files == 0xFFFF) || (level > MZ_UBER_COMPRESSION))
+        if ((!pZip) || (!pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_WRITING) || ((buf_size) && (!pBuf)) || (!pArchive_name) || ((comment_size) && (!pComment)) || (pZip->m_total_files == 0xFFFFFFFF) || (level > MZ_UBER_COMPRESSION))
             return MZ_FALSE;
 
         pState = pZip->m_pState;
 
         if ((!(level_and_flags & MZ_ZIP_FLAG_COMPRESSED_DATA)) && (uncomp_size))
             return MZ_FALSE;
-        // No zip64 support yet
-        if ((buf_size > 0xFFFFFFFF) || (uncomp_size > 0xFFFFFFFF))
-            return MZ_FALSE;
+        zip64 = mz_zip_writer_size_needs_zip64(MZ_MAX((mz_uint64)buf_size, uncomp_size));
+        local_extra_size = zip64 ? (4 + sizeof(mz_uint64) * 2) : 0;
         if (!mz_zip_writer_validate_archive_name(pArchive_name))
             return MZ_FALSE;
 
@@ -4355,8 +5090,8 @@ extern "C" {
 
         num_alignment_padding_bytes = mz_zip_writer_compute_padding_needed_for_file_alignment(pZip);
 
-        // no zip64 support yet
-        if ((pZip->m_total_files == 0xFFFF) || ((pZip->m_archive_size + num_alignment_padding_bytes + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + comment_size + archive_name_size) > 0xFFFFFFFF))
+        // Local data may live past 4GB (Zip64), but the central directory must stay addressable with 32-bit offsets.
+        if ((pZip->m_total_files == 0xFFFFFFFF) || (((mz_uint64)pState->m_central_dir.m_size + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + archive_name_size + MZ_ZIP64_MAX_EXTRA_FIELD_SIZE + comment_size) > 0xFFFFFFFF))
             return MZ_FALSE;
 
         if ((archive_name_size) && (pArchive_name[archive_name_size - 1] == '/'))
@@ -4369,7 +5104,7 @@ extern "C" {
         }
 
         // Try to do any allocations before writing to the archive, so if an allocation fails the file remains unmodified. (A good idea if we're doing an in-place modification.)
-        if ((!mz_zip_array_ensure_room(pZip, &pState->m_central_dir, MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + archive_name_size + comment_size)) || (!mz_zip_array_ensure_room(pZip, &pState->m_central_dir_offsets, 1)))
+        if ((!mz_zip_array_ensure_room(pZip, &pState->m_central_dir, MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + archive_name_size + MZ_ZIP64_MAX_EXTRA_FIELD_SIZE + comment_size)) || (!mz_zip_array_ensure_room(pZip, &pState->m_central_dir_offsets, 1)))
             return MZ_FALSE;
 
         if ((!store_data_uncompressed) && (buf_size))
@@ -4395,6 +5130,14 @@ extern "C" {
         }
         cur_archive_file_ofs += archive_name_size;
 
+        // Room for the Zip64 sizes, filled in once the compressed size is known.
+        if (!mz_zip_writer_write_zeros(pZip, cur_archive_file_ofs, local_extra_size))
+        {
+            pZip->m_pFree(pZip->m_pAlloc_opaque, pComp);
+            return MZ_FALSE;
+        }
+        cur_archive_file_ofs += local_extra_size;
+
         if (!(level_and_flags & MZ_ZIP_FLAG_COMPRESSED_DATA))
         {
             uncomp_crc32 = (mz_uint32)mz_crc32(MZ_CRC32_INIT, (const mz_uint8*)pBuf, buf_size);
@@ -4417,7 +5160,8 @@ extern "C" {
             cur_archive_file_ofs += buf_size;
             comp_size = buf_size;
 
-            if (level_and_flags & MZ_ZIP_FLAG_COMPRESSED_DATA)
+            // level 0 with MZ_ZIP_FLAG_COMPRESSED_DATA means stored data with a precomputed crc
+            if ((level_and_flags & MZ_ZIP_FLAG_COMPRESSED_DATA) && (level))
                 method = MZ_DEFLATED;
         }
         else if (buf_size)
@@ -4444,16 +5188,19 @@ extern "C" {
         pZip->m_pFree(pZip->m_pAlloc_opaque, pComp);
         pComp = NULL;
 
-        // no zip64 support yet
-        if ((comp_size > 0xFFFFFFFF) || (cur_archive_file_ofs > 0xFFFFFFFF))
-            return MZ_FALSE;
-
-        if (!mz_zip_writer_create_local_dir_header(pZip, local_dir_header, (mz_uint16)archive_name_size, 0, uncomp_size, comp_size, uncomp_crc32, method, 0, dos_time, dos_date))
+        if (!mz_zip_writer_create_local_dir_header(pZip, local_dir_header, (mz_uint16)archive_name_size, (mz_uint16)local_extra_size, uncomp_size, comp_size, uncomp_crc32, method, 0, dos_time, dos_date, zip64))
             return MZ_FALSE;
 
         if (pZip->m_pWrite(pZip->m_pIO_opaque, local_dir_header_ofs, local_dir_header, sizeof(local_dir_header)) != sizeof(local_dir_header))
             return MZ_FALSE;
 
+        if (zip64)
+        {
+            mz_zip_writer_create_zip64_extra_data(local_extra, &uncomp_size, &comp_size, NULL);
+            if (pZip->m_pWrite(pZip->m_pIO_opaque, local_dir_header_ofs + sizeof(local_dir_header) + archive_name_size, local_extra, local_extra_size) != local_extra_size)
+                return MZ_FALSE;
+        }
+
         if (!mz_zip_writer_add_to_central_dir(pZip, pArchive_name, (mz_uint16)archive_name_size, NULL, 0, pComment, comment_size, uncomp_size, comp_size, uncomp_crc32, method, 0, dos_time, dos_date, local_dir_header_ofs, ext_attributes))
             return MZ_FALSE;
 
@@ -4471,6 +5218,10 @@ extern "C" {
         mz_uint64 local_dir_header_ofs = pZip->m_archive_size, cur_archive_file_ofs = pZip->m_archive_size, uncomp_size = 0, comp_size = 0;
         size_t archive_name_size;
         mz_uint8 local_dir_header[MZ_ZIP_LOCAL_DIR_HEADER_SIZE];
+        mz_uint8 local_extra[MZ_ZIP64_MAX_EXTRA_FIELD_SIZE];
+        mz_uint local_extra_size;
+        mz_bool zip64;
+        mz_zip_internal_state* pState;
         MZ_FILE* pSrc_file = NULL;
 
         if ((int)level_and_flags < 0)
@@ -4483,6 +5234,7 @@ extern "C" {
             return MZ_FALSE;
         if (!mz_zip_writer_validate_archive_name(pArchive_name))
             return MZ_FALSE;
+        pState = pZip->m_pState;
 
         archive_name_size = strlen(pArchive_name);
         if (archive_name_size > 0xFFFF)
@@ -4490,8 +5242,8 @@ extern "C" {
 
         num_alignment_padding_bytes = mz_zip_writer_compute_padding_needed_for_file_alignment(pZip);
 
-        // no zip64 support yet
-        if ((pZip->m_total_files == 0xFFFF) || ((pZip->m_archive_size + num_alignment_padding_bytes + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + comment_size + archive_name_size) > 0xFFFFFFFF))
+        // Local data may live past 4GB (Zip64), but the central directory must stay addressable with 32-bit offsets.
+        if ((pZip->m_total_files == 0xFFFFFFFF) || (((mz_uint64)pState->m_central_dir.m_size + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + archive_name_size + MZ_ZIP64_MAX_EXTRA_FIELD_SIZE + comment_size) > 0xFFFFFFFF))
             return MZ_FALSE;
 
         if (!mz_zip_get_file_modified_time(pSrc_filename, &dos_time, &dos_date))
@@ -4504,15 +5256,17 @@ extern "C" {
         uncomp_size = MZ_FTELL64(pSrc_file);
         MZ_FSEEK64(pSrc_file, 0, SEEK_SET);
 
-        if (uncomp_size > 0xFFFFFFFF)
-        {
-            // No zip64 support yet
-            MZ_FCLOSE(pSrc_file);
-            return MZ_FALSE;
-        }
+        zip64 = mz_zip_writer_size_needs_zip64(uncomp_size);
+        local_extra_size = zip64 ? (4 + sizeof(mz_uint64) * 2) : 0;
         if (uncomp_size <= 3)
             level = 0;
 
+        if ((!mz_zip_array_ensure_room(pZip, &pState->m_central_dir, MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + archive_name_size + MZ_ZIP64_MAX_EXTRA_FIELD_SIZE + comment_size)) || (!mz_zip_array_ensure_room(pZip, &pState->m_central_dir_offsets, 1)))
+        {
+            MZ_FCLOSE(pSrc_file);
+            return MZ_FALSE;
+        }
+
         if (!mz_zip_writer_write_zeros(pZip, cur_archive_file_ofs, num_alignment_padding_bytes + sizeof(local_dir_header)))
         {
             MZ_FCLOSE(pSrc_file);
@@ -4530,6 +5284,13 @@ extern "C" {
         }
         cur_archive_file_ofs += archive_name_size;
 
+        if (!mz_zip_writer_write_zeros(pZip, cur_archive_file_ofs, local_extra_size))
+        {
+            MZ_FCLOSE(pSrc_file);
+            return MZ_FALSE;
+        }
+        cur_archive_file_ofs += local_extra_size;
+
         if (uncomp_size)
         {
             mz_uint64 uncomp_remaining = uncomp_size;
@@ -4622,16 +5383,19 @@ extern "C" {
 
         MZ_FCLOSE(pSrc_file); pSrc_file = NULL;
 
-        // no zip64 support yet
-        if ((comp_size > 0xFFFFFFFF) || (cur_archive_file_ofs > 0xFFFFFFFF))
-            return MZ_FALSE;
-
-        if (!mz_zip_writer_create_local_dir_header(pZip, local_dir_header, (mz_uint16)archive_name_size, 0, uncomp_size, comp_size, uncomp_crc32, method, 0, dos_time, dos_date))
+        if (!mz_zip_writer_create_local_dir_header(pZip, local_dir_header, (mz_uint16)archive_name_size, (mz_uint16)local_extra_size, uncomp_size, comp_size, uncomp_crc32, method, 0, dos_time, dos_date, zip64))
             return MZ_FALSE;
 
         if (pZip->m_pWrite(pZip->m_pIO_opaque, local_dir_header_ofs, local_dir_header, sizeof(local_dir_header)) != sizeof(local_dir_header))
             return MZ_FALSE;
 
+        if (zip64)
+        {
+            mz_zip_writer_create_zip64_extra_data(local_extra, &uncomp_size, &comp_size, NULL);
+            if (pZip->m_pWrite(pZip->m_pIO_opaque, local_dir_header_ofs + sizeof(local_dir_header) + archive_name_size, local_extra, local_extra_size) != local_extra_size)
+                return MZ_FALSE;
+        }
+
         if (!mz_zip_writer_add_to_central_dir(pZip, pArchive_name, (mz_uint16)archive_name_size, NULL, 0, pComment, comment_size, uncomp_size, comp_size, uncomp_crc32, method, 0, dos_time, dos_date, local_dir_header_ofs, ext_attributes))
             return MZ_FALSE;
 
@@ -4642,30 +5406,127 @@ extern "C" {
     }
 #endif // #ifndef MINIZ_NO_STDIO
 
+    mz_bool mz_zip_writer_add_read_func_stored(mz_zip_archive* pZip, const char* pArchive_name, mz_file_read_func read_func, void* pOpaque, mz_uint64 uncomp_size)
+    {
+        mz_uint uncomp_crc32 = MZ_CRC32_INIT, num_alignment_padding_bytes;
+        mz_uint16 dos_time = 0, dos_date = 0;
+        mz_uint64 local_dir_header_ofs, cur_archive_file_ofs, uncomp_remaining = uncomp_size, comp_size = uncomp_size;
+        size_t archive_name_size;
+        mz_uint8 local_dir_header[MZ_ZIP_LOCAL_DIR_HEADER_SIZE];
+        mz_uint8 local_extra[MZ_ZIP64_MAX_EXTRA_FIELD_SIZE];
+        mz_uint local_extra_size;
+        mz_bool zip64;
+        mz_zip_internal_state* pState;
+        void* pRead_buf;
+
+        if ((!pZip) || (!pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_WRITING) || (!pArchive_name) || (!read_func))
+            return MZ_FALSE;
+        if (!mz_zip_writer_validate_archive_name(pArchive_name))
+            return MZ_FALSE;
+        pState = pZip->m_pState;
+        local_dir_header_ofs = cur_archive_file_ofs = pZip->m_archive_size;
+
+        archive_name_size = strlen(pArchive_name);
+        if ((archive_name_size > 0xFFFF) || ((archive_name_size) && (pArchive_name[archive_name_size - 1] == '/')))
+            return MZ_FALSE;
+
+        num_alignment_padding_bytes = mz_zip_writer_compute_padding_needed_for_file_alignment(pZip);
+
+        // Local data may live past 4GB (Zip64), but the central directory must stay addressable with 32-bit offsets.
+        if ((pZip->m_total_files == 0xFFFFFFFF) || (((mz_uint64)pState->m_central_dir.m_size + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + archive_name_size + MZ_ZIP64_MAX_EXTRA_FIELD_SIZE) > 0xFFFFFFFF))
+            return MZ_FALSE;
+
+#ifndef MINIZ_NO_TIME
+        {
+            time_t cur_time; time(&cur_time);
+            mz_zip_time_to_dos_time(cur_time, &dos_time, &dos_date);
+        }
+#endif // #ifndef MINIZ_NO_TIME
+
+        zip64 = mz_zip_writer_size_needs_zip64(uncomp_size);
+        local_extra_size = zip64 ? (4 + sizeof(mz_uint64) * 2) : 0;
+
+        if ((!mz_zip_array_ensure_room(pZip, &pState->m_central_dir, MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + archive_name_size + MZ_ZIP64_MAX_EXTRA_FIELD_SIZE)) || (!mz_zip_array_ensure_room(pZip, &pState->m_central_dir_offsets, 1)))
+            return MZ_FALSE;
+
+        if (!mz_zip_writer_write_zeros(pZip, cur_archive_file_ofs, num_alignment_padding_bytes + sizeof(local_dir_header)))
+            return MZ_FALSE;
+        local_dir_header_ofs += num_alignment_padding_bytes;
+        if (pZip->m_file_offset_alignment) { MZ_ASSERT((local_dir_header_ofs & (pZip->m_file_offset_alignment - 1)) == 0); }
+        cur_archive_file_ofs += num_alignment_padding_bytes + sizeof(local_dir_header);
+
+        MZ_CLEAR_OBJ(local_dir_header);
+        if (pZip->m_pWrite(pZip->m_pIO_opaque, cur_archive_file_ofs, pArchive_name, archive_name_size) != archive_name_size)
+            return MZ_FALSE;
+        cur_archive_file_ofs += archive_name_size;
+
+        if (!mz_zip_writer_write_zeros(pZip, cur_archive_file_ofs, local_extra_size))
+            return MZ_FALSE;
+        cur_archive_file_ofs += local_extra_size;
+
+        if (NULL == (pRead_buf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, MZ_ZIP_MAX_IO_BUF_SIZE)))
+            return MZ_FALSE;
+        while (uncomp_remaining)
+        {
+            mz_uint n = (mz_uint)MZ_MIN(MZ_ZIP_MAX_IO_BUF_SIZE, uncomp_remaining);
+            if ((read_func(pOpaque, uncomp_size - uncomp_remaining, pRead_buf, n) != n) || (pZip->m_pWrite(pZip->m_pIO_opaque, cur_archive_file_ofs, pRead_buf, n) != n))
+            {
+                pZip->m_pFree(pZip->m_pAlloc_opaque, pRead_buf);
+                return MZ_FALSE;
+            }
+            uncomp_crc32 = (mz_uint32)mz_crc32(uncomp_crc32, (const mz_uint8*)pRead_buf, n);
+            uncomp_remaining -= n;
+            cur_archive_file_ofs += n;
+        }
+        pZip->m_pFree(pZip->m_pAlloc_opaque, pRead_buf);
+
+        if (!mz_zip_writer_create_local_dir_header(pZip, local_dir_header, (mz_uint16)archive_name_size, (mz_uint16)local_extra_size, uncomp_size, comp_size, uncomp_crc32, 0, 0, dos_time, dos_date, zip64))
+            return MZ_FALSE;
+
+        if (pZip->m_pWrite(pZip->m_pIO_opaque, local_dir_header_ofs, local_dir_header, sizeof(local_dir_header)) != sizeof(local_dir_header))
+            return MZ_FALSE;
+
+        if (zip64)
+        {
+            mz_zip_writer_create_zip64_extra_data(local_extra, &uncomp_size, &comp_size, NULL);
+            if (pZip->m_pWrite(pZip->m_pIO_opaque, local_dir_header_ofs + sizeof(local_dir_header) + archive_name_size, local_extra, local_extra_size) != local_extra_size)
+                return MZ_FALSE;
+        }
+
+        if (!mz_zip_writer_add_to_central_dir(pZip, pArchive_name, (mz_uint16)archive_name_size, NULL, 0, NULL, 0, uncomp_size, comp_size, uncomp_crc32, 0, 0, dos_time, dos_date, local_dir_header_ofs, 0))
+            return MZ_FALSE;
+
+        pZip->m_total_files++;
+        pZip->m_archive_size = cur_archive_file_ofs;
+
+        return MZ_TRUE;
+    }
+
     mz_bool mz_zip_writer_add_from_zip_reader(mz_zip_archive* pZip, mz_zip_archive* pSource_zip, mz_uint file_index)
     {
-        mz_uint n, bit_flags, num_alignment_padding_bytes;
-        mz_uint64 comp_bytes_remaining, local_dir_header_ofs;
+        mz_uint n, bit_flags, num_alignment_padding_bytes, src_extra_size, ext_ofs, zip64_extra_size = 0;
+        mz_uint64 comp_bytes_remaining, local_dir_header_ofs, src_comp_size, src_uncomp_size;
         mz_uint64 cur_src_file_ofs, cur_dst_file_ofs;
         mz_uint32 local_header_u32[(MZ_ZIP_LOCAL_DIR_HEADER_SIZE + sizeof(mz_uint32) - 1) / sizeof(mz_uint32)]; mz_uint8* pLocal_header = (mz_uint8*)local_header_u32;
         mz_uint8 central_header[MZ_ZIP_CENTRAL_DIR_HEADER_SIZE];
+        mz_uint8 zip64_extra[MZ_ZIP64_MAX_EXTRA_FIELD_SIZE];
         size_t orig_central_dir_size;
         mz_zip_internal_state* pState;
-        void* pBuf; const mz_uint8* pSrc_central_header;
+        void* pBuf; const mz_uint8* pSrc_central_header; const mz_uint8* pSrc_extra;
 
         if ((!pZip) || (!pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_WRITING))
             return MZ_FALSE;
         if (NULL == (pSrc_central_header = mz_zip_reader_get_cdh(pSource_zip, file_index)))
             return MZ_FALSE;
+        if (!mz_zip_reader_get_cdh_sizes(pSrc_central_header, &src_comp_size, &src_uncomp_size, &cur_src_file_ofs))
+            return MZ_FALSE;
         pState = pZip->m_pState;
 
         num_alignment_padding_bytes = mz_zip_writer_compute_padding_needed_for_file_alignment(pZip);
 
-        // no zip64 support yet
-        if ((pZip->m_total_files == 0xFFFF) || ((pZip->m_archive_size + num_alignment_padding_bytes + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE) > 0xFFFFFFFF))
+        if (pZip->m_total_files == 0xFFFFFFFF)
             return MZ_FALSE;
 
-        cur_src_file_ofs = MZ_READ_LE32(pSrc_central_header + MZ_ZIP_CDH_LOCAL_HEADER_OFS);
         cur_dst_file_ofs = pZip->m_archive_size;
 
         if (pSource_zip->m_pRead(pSource_zip->m_pIO_opaque, cur_src_file_ofs, pLocal_header, MZ_ZIP_LOCAL_DIR_HEADER_SIZE) != MZ_ZIP_LOCAL_DIR_HEADER_SIZE)
@@ -4685,9 +5546,9 @@ extern "C" {
         cur_dst_file_ofs += MZ_ZIP_LOCAL_DIR_HEADER_SIZE;
 
         n = MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_FILENAME_LEN_OFS) + MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
-        comp_bytes_remaining = n + MZ_READ_LE32(pSrc_central_header + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS);
+        comp_bytes_remaining = n + src_comp_size;
 
-        if (NULL == (pBuf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, (size_t)MZ_MAX(sizeof(mz_uint32) * 4, MZ_MIN(MZ_ZIP_MAX_IO_BUF_SIZE, comp_bytes_remaining)))))
+        if (NULL == (pBuf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, (size_t)MZ_MAX(sizeof(mz_uint32) * 6, MZ_MIN(MZ_ZIP_MAX_IO_BUF_SIZE, comp_bytes_remaining)))))
             return MZ_FALSE;
 
         while (comp_bytes_remaining)
@@ -4713,14 +5574,16 @@ extern "C" {
         bit_flags = MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_BIT_FLAG_OFS);
         if (bit_flags & 8)
         {
-            // Copy data descriptor
-            if (pSource_zip->m_pRead(pSource_zip->m_pIO_opaque, cur_src_file_ofs, pBuf, sizeof(mz_uint32) * 4) != sizeof(mz_uint32) * 4)
+            // Copy data descriptor (its sizes are 64-bit when the entry needed Zip64)
+            mz_bool zip64_descriptor = (src_comp_size >= 0xFFFFFFFF) || (src_uncomp_size >= 0xFFFFFFFF);
+            n = sizeof(mz_uint32) * (zip64_descriptor ? 6 : 4);
+            if (pSource_zip->m_pRead(pSource_zip->m_pIO_opaque, cur_src_file_ofs, pBuf, n) != n)
             {
                 pZip->m_pFree(pZip->m_pAlloc_opaque, pBuf);
                 return MZ_FALSE;
             }
 
-            n = sizeof(mz_uint32) * ((MZ_READ_LE32(pBuf) == 0x08074b50) ? 4 : 3);
+            n = sizeof(mz_uint32) * ((zip64_descriptor ? 5 : 3) + ((MZ_READ_LE32(pBuf) == 0x08074b50) ? 1 : 0));
             if (pZip->m_pWrite(pZip->m_pIO_opaque, cur_dst_file_ofs, pBuf, n) != n)
             {
                 pZip->m_pFree(pZip->m_pAlloc_opaque, pBuf);
@@ -4732,26 +5595,59 @@ extern "C" {
         }
         pZip->m_pFree(pZip->m_pAlloc_opaque, pBuf);
 
-        // no zip64 support yet
-        if (cur_dst_file_ofs > 0xFFFFFFFF)
-            return MZ_FALSE;
-
         orig_central_dir_size = pState->m_central_dir.m_size;
 
+        // The entry moves, so its Zip64 field (if any) is rebuilt for the new offset and the source's copy is dropped.
+        if ((src_uncomp_size >= 0xFFFFFFFF) || (src_comp_size >= 0xFFFFFFFF) || (local_dir_header_ofs >= 0xFFFFFFFF))
+        {
+            zip64_extra_size = mz_zip_writer_create_zip64_extra_data(zip64_extra, (src_uncomp_size >= 0xFFFFFFFF) ? &src_uncomp_size : NULL,
+                (src_comp_size >= 0xFFFFFFFF) ? &src_comp_size : NULL, (local_dir_header_ofs >= 0xFFFFFFFF) ? &local_dir_header_ofs : NULL);
+        }
+
         memcpy(central_header, pSrc_central_header, MZ_ZIP_CENTRAL_DIR_HEADER_SIZE);
-        MZ_WRITE_LE32(central_header + MZ_ZIP_CDH_LOCAL_HEADER_OFS, local_dir_header_ofs);
-        if (!mz_zip_array_push_back(pZip, &pState->m_central_dir, central_header, MZ_ZIP_CENTRAL_DIR_HEADER_SIZE))
+        MZ_WRITE_LE32(central_header + MZ_ZIP_CDH_LOCAL_HEADER_OFS, MZ_MIN(local_dir_header_ofs, 0xFFFFFFFF));
+        if (zip64_extra_size)
+            MZ_WRITE_LE16(central_header + MZ_ZIP_CDH_VERSION_NEEDED_OFS, MZ_MAX(MZ_READ_LE16(central_header + MZ_ZIP_CDH_VERSION_NEEDED_OFS), MZ_ZIP64_VERSION_NEEDED));
+        n = MZ_READ_LE16(pSrc_central_header + MZ_ZIP_CDH_FILENAME_LEN_OFS);
+        src_extra_size = MZ_READ_LE16(pSrc_central_header + MZ_ZIP_CDH_EXTRA_LEN_OFS);
+        pSrc_extra = pSrc_central_header + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + n;
+        if ((!mz_zip_array_push_back(pZip, &pState->m_central_dir, central_header, MZ_ZIP_CENTRAL_DIR_HEADER_SIZE)) ||
+            (!mz_zip_array_push_back(pZip, &pState->m_central_dir, pSrc_central_header + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE, n)) ||
+            (!mz_zip_array_push_back(pZip, &pState->m_central_dir, zip64_extra, zip64_extra_size)))
+        {
+            mz_zip_array_resize(pZip, &pState->m_central_dir, orig_central_dir_size, MZ_FALSE);
             return MZ_FALSE;
+        }
 
-        n = MZ_READ_LE16(pSrc_central_header + MZ_ZIP_CDH_FILENAME_LEN_OFS) + MZ_READ_LE16(pSrc_central_header + MZ_ZIP_CDH_EXTRA_LEN_OFS) + MZ_READ_LE16(pSrc_central_header + MZ_ZIP_CDH_COMMENT_LEN_OFS);
-        if (!mz_zip_array_push_back(pZip, &pState->m_central_dir, pSrc_central_header + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE, n))
+        n = zip64_extra_size;
+        for (ext_ofs = 0; ext_ofs + 4 <= src_extra_size; )
+        {
+            mz_uint field_id = MZ_READ_LE16(pSrc_extra + ext_ofs), field_size = 4 + MZ_READ_LE16(pSrc_extra + ext_ofs + 2);
+            if (ext_ofs + field_size > src_extra_size)
+                break;
+            if (field_id != MZ_ZIP64_EXTENDED_INFORMATION_FIELD_HEADER_ID)
+            {
+                if (!mz_zip_array_push_back(pZip, &pState->m_central_dir, pSrc_extra + ext_ofs, field_size))
+                {
+                    mz_zip_array_resize(pZip, &pState->m_central_dir, orig_central_dir_size, MZ_FALSE);
+                    return MZ_FALSE;
+                }
+                n += field_size;
+            }
+            ext_ofs += field_size;
+        }
+        if ((n > 0xFFFF) || (!mz_zip_array_push_back(pZip, &pState->m_central_dir, pSrc_extra + src_extra_size, MZ_READ_LE16(pSrc_central_header + MZ_ZIP_CDH_COMMENT_LEN_OFS))))
         {
             mz_zip_array_resize(pZip, &pState->m_central_dir, orig_central_dir_size, MZ_FALSE);
             return MZ_FALSE;
         }
+        MZ_WRITE_LE16((mz_uint8*)pState->m_central_dir.m_p + orig_central_dir_size + MZ_ZIP_CDH_EXTRA_LEN_OFS, n);
 
         if (pState->m_central_dir.m_size > 0xFFFFFFFF)
+        {
+            mz_zip_array_resize(pZip, &pState->m_central_dir, orig_central_dir_size, MZ_FALSE);
             return MZ_FALSE;
+        }
         n = (mz_uint32)orig_central_dir_size;
         if (!mz_zip_array_push_back(pZip, &pState->m_central_dir_offsets, &n, 1))
         {
@@ -4770,16 +5666,13 @@ extern "C" {
         mz_zip_internal_state* pState;
         mz_uint64 central_dir_ofs, central_dir_size;
         mz_uint8 hdr[MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE];
+        mz_uint8 zip64_hdr[MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE + MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE];
 
         if ((!pZip) || (!pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_WRITING))
             return MZ_FALSE;
 
         pState = pZip->m_pState;
 
-        // no zip64 support yet
-        if ((pZip->m_total_files > 0xFFFF) || ((pZip->m_archive_size + pState->m_central_dir.m_size + MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE) > 0xFFFFFFFF))
-            return MZ_FALSE;
-
         central_dir_ofs = 0;
         central_dir_size = 0;
         if (pZip->m_total_files)
@@ -4793,13 +5686,35 @@ extern "C" {
             pZip->m_archive_size += central_dir_size;
         }
 
+        // Write the Zip64 end of central directory record and its locator when the classic record can't hold the values
+        if ((pZip->m_total_files >= 0xFFFF) || (central_dir_ofs >= 0xFFFFFFFF) || (central_dir_size >= 0xFFFFFFFF))
+        {
+            mz_uint8* pLocator = zip64_hdr + MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE;
+            MZ_CLEAR_OBJ(zip64_hdr);
+            MZ_WRITE_LE32(zip64_hdr + MZ_ZIP64_ECDH_SIG_OFS, MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIG);
+            MZ_WRITE_LE64(zip64_hdr + MZ_ZIP64_ECDH_SIZE_OF_RECORD_OFS, MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE - sizeof(mz_uint32) - sizeof(mz_uint64));
+            MZ_WRITE_LE16(zip64_hdr + MZ_ZIP64_ECDH_VERSION_MADE_BY_OFS, MZ_ZIP64_VERSION_NEEDED);
+            MZ_WRITE_LE16(zip64_hdr + MZ_ZIP64_ECDH_VERSION_NEEDED_OFS, MZ_ZIP64_VERSION_NEEDED);
+            MZ_WRITE_LE64(zip64_hdr + MZ_ZIP64_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS, pZip->m_total_files);
+            MZ_WRITE_LE64(zip64_hdr + MZ_ZIP64_ECDH_CDIR_TOTAL_ENTRIES_OFS, pZip->m_total_files);
+            MZ_WRITE_LE64(zip64_hdr + MZ_ZIP64_ECDH_CDIR_SIZE_OFS, central_dir_size);
+            MZ_WRITE_LE64(zip64_hdr + MZ_ZIP64_ECDH_CDIR_OFS_OFS, central_dir_ofs);
+            MZ_WRITE_LE32(pLocator + MZ_ZIP64_ECDL_SIG_OFS, MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIG);
+            MZ_WRITE_LE64(pLocator + MZ_ZIP64_ECDL_REL_OFS_TO_ZIP64_ECDR_OFS, pZip->m_archive_size);
+            MZ_WRITE_LE32(pLocator + MZ_ZIP64_ECDL_TOTAL_NUMBER_OF_DISKS_OFS, 1);
+
+            if (pZip->m_pWrite(pZip->m_pIO_opaque, pZip->m_archive_size, zip64_hdr, sizeof(zip64_hdr)) != sizeof(zip64_hdr))
+                return MZ_FALSE;
+            pZip->m_archive_size += sizeof(zip64_hdr);
+        }
+
         // Write end of central directory record
         MZ_CLEAR_OBJ(hdr);
         MZ_WRITE_LE32(hdr + MZ_ZIP_ECDH_SIG_OFS, MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIG);
-        MZ_WRITE_LE16(hdr + MZ_ZIP_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS, pZip->m_total_files);
-        MZ_WRITE_LE16(hdr + MZ_ZIP_ECDH_CDIR_TOTAL_ENTRIES_OFS, pZip->m_total_files);
-        MZ_WRITE_LE32(hdr + MZ_ZIP_ECDH_CDIR_SIZE_OFS, central_dir_size);
-        MZ_WRITE_LE32(hdr + MZ_ZIP_ECDH_CDIR_OFS_OFS, central_dir_ofs);
+        MZ_WRITE_LE16(hdr + MZ_ZIP_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS, MZ_MIN(pZip->m_total_files, 0xFFFF));
+        MZ_WRITE_LE16(hdr + MZ_ZIP_ECDH_CDIR_TOTAL_ENTRIES_OFS, MZ_MIN(pZip->m_total_files, 0xFFFF));
+        MZ_WRITE_LE32(hdr + MZ_ZIP_ECDH_CDIR_SIZE_OFS, MZ_MIN(central_dir_size, 0xFFFFFFFF));
+        MZ_WRITE_LE32(hdr + MZ_ZIP_ECDH_CDIR_OFS_OFS, MZ_MIN(central_dir_ofs, 0xFFFFFFFF));
 
         if (pZip->m_pWrite(pZip->m_pIO_opaque, pZip->m_archive_size, hdr, sizeof(hdr)) != sizeof(hdr))
             return MZ_FALSE;
@@ -5117,14 +6032,65 @@ namespace miniz_cpp {
                 buffer->resize(new_size);
             }
 
-            for (std::size_t i = 0; i < n; i++)
+            std::memcpy(buffer->data() + file_ofs, pBuf, n);
+
+            return n;
+        }
+
+        std::size_t stream_write_callback(void* pOpaque, mz_uint64 /*file_ofs*/, const void* pBuf, size_t n)
+        {
+            auto stream = static_cast<std::ofstream*>(pOpaque);
+            stream->write(static_cast<const char*>(pBuf), static_cast<std::streamsize>(n));
+            return stream->good() ? n : 0;
+        }
+
+        struct file_sink
+        {
+            static constexpr std::size_t buffer_size = 1 << 20;
+
+            file_sink(const std::string& filename) : path(filename), buffer(buffer_size)
+            {
+                stream.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                stream.open(path, std::ios::binary | std::ios::trunc);
+            }
+
+            std::filesystem::path path;
+            std::vector<char> buffer;
+            std::ofstream stream;
+            mz_uint64 position = 0;
+        };
+
+        // miniz goes back to patch local headers after the data, so seeks are
+        // only issued when the offset isn't the current end of the written data
+        std::size_t file_write_callback(void* pOpaque, mz_uint64 file_ofs, const void* pBuf, size_t n)
+        {
+            auto sink = static_cast<file_sink*>(pOpaque);
+
+            if (file_ofs != sink->position)
+            {
+                sink->stream.seekp(static_cast<std::streamoff>(file_ofs));
+            }
+            sink->stream.write(static_cast<const char*>(pBuf), static_cast<std::streamsize>(n));
+            if (!sink->stream)
             {
-                (*buffer)[static_cast<std::size_t>(file_ofs + i)] = (static_cast<const char*>(pBuf))[i];
+                return 0;
             }
+            sink->position = file_ofs + n;
 
             return n;
         }
 
+        std::size_t read_callback(void* pOpaque, mz_uint64 file_ofs, void* pBuf, size_t n)
+        {
+            auto stream = static_cast<std::ifstream*>(pOpaque);
+
+            stream->clear();
+            stream->seekg(static_cast<std::streamoff>(file_ofs));
+            stream->read(static_cast<char*>(pBuf), static_cast<std::streamsize>(n));
+
+            return static_cast<std::size_t>(stream->gcount());
+        }
+
     } // namespace detail
 
     struct zip_info
@@ -5156,6 +6122,122 @@ namespace miniz_cpp {
         std::size_t file_size = 0;
     };
 
+    enum class content_class
+    {
+        text,
+        binary,
+        compressed
+    };
+
+    // picks a compression level per entry, already compressed payloads (.geode packages
+    // are zips themselves, png, ogg...) are stored since deflating them gains nothing
+    struct compression_policy
+    {
+        int text_level = MZ_BEST_COMPRESSION;
+        int binary_level = MZ_DEFAULT_LEVEL;
+        int compressed_level = MZ_NO_COMPRESSION;
+
+        // unknown payloads bigger than a sample are test-compressed at the fastest level
+        std::size_t sample_size = 64 * 1024;
+        double min_sample_gain = 0.05;
+
+        content_class classify(const std::string& arcname, const std::string& bytes) const
+        {
+            static const char* compressed_extensions[] = {
+                ".geode", ".zip", ".png", ".jpg", ".jpeg", ".webp", ".ogg", ".mp3", ".m4a", ".flac",
+                ".mp4", ".webm", ".gz", ".xz", ".bz2", ".7z", ".rar", ".zst", ".geode_modpack"
+            };
+            static const char* text_extensions[] = {
+                ".json", ".txt", ".md", ".ini", ".xml", ".plist", ".csv", ".yml", ".yaml", ".toml", ".log", ".geode_modlist"
+            };
+
+            auto dot = arcname.rfind('.');
+            auto extension = dot == std::string::npos ? std::string() : arcname.substr(dot);
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+                return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            });
+
+            for (auto known : compressed_extensions)
+            {
+                if (extension == known) return content_class::compressed;
+            }
+            if (has_compressed_magic(bytes))
+            {
+                return content_class::compressed;
+            }
+            for (auto known : text_extensions)
+            {
+                if (extension == known) return content_class::text;
+            }
+
+            if (bytes.size() > sample_size && !sample_compresses(bytes))
+            {
+                return content_class::compressed;
+            }
+
+            auto probe = std::min(bytes.size(), sample_size);
+            return std::memchr(bytes.data(), 0, probe) == nullptr ? content_class::text : content_class::binary;
+        }
+
+        int level_for(const std::string& arcname, const std::string& bytes) const
+        {
+            switch (classify(arcname, bytes))
+            {
+            case content_class::text: return text_level;
+            case content_class::binary: return binary_level;
+            case content_class::compressed: return compressed_level;
+            }
+            return text_level;
+        }
+
+        // the level level_for picks for a whole file, from at most sample_size + 1 bytes of its start
+        int level_for_file(const std::string& arcname, const std::filesystem::path& path) const
+        {
+            std::ifstream file(path, std::ios::binary);
+            std::string head(sample_size + 1, '\0');
+            file.read(head.data(), static_cast<std::streamsize>(head.size()));
+            head.resize(static_cast<std::size_t>(file.gcount()));
+            return level_for(arcname, head);
+        }
+
+    private:
+        static bool has_compressed_magic(const std::string& bytes)
+        {
+            auto starts_with = [&bytes](const char* magic, std::size_t size, std::size_t offset = 0) {
+                return bytes.size() >= offset + size && std::memcmp(bytes.data() + offset, magic, size) == 0;
+            };
+            return starts_with("PK\x03\x04", 4)
+                || starts_with("\x89PNG", 4)
+                || starts_with("OggS", 4)
+                || starts_with("\xFF\xD8\xFF", 3)
+                || starts_with("ID3", 3)
+                || starts_with("fLaC", 4)
+                || starts_with("\x1F\x8B", 2)
+                || starts_with("7z\xBC\xAF", 4)
+                || starts_with("\x28\xB5\x2F\xFD", 4)
+                || (starts_with("RIFF", 4) && starts_with("WEBP", 4, 8));
+        }
+
+        bool sample_compresses(const std::string& bytes) const
+        {
+            auto limit = static_cast<std::size_t>(static_cast<double>(sample_size) * (1.0 - min_sample_gain));
+            std::vector<char> out(limit);
+            auto flags = static_cast<int>(tdefl_create_comp_flags_from_zip_params(MZ_BEST_SPEED, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY));
+            // fails when the output doesn't fit, meaning the sample didn't shrink enough
+            return tdefl_compress_mem_to_mem(out.data(), out.size(), bytes.data(), sample_size, flags) != 0;
+        }
+    };
+
+    // entry payload prepared outside of the archive, see zip_file::compress
+    struct compressed_entry
+    {
+        std::string arcname;
+        std::string data;
+        std::size_t file_size = 0;
+        uint32_t crc = 0;
+        bool deflated = false;
+    };
+
     class zip_file
     {
     public:
@@ -5207,8 +6289,67 @@ namespace miniz_cpp {
             start_read();
         }
 
+        // opens the archive without loading it into memory, only the central directory
+        // is read up front and entries are read from disk when requested
+        void load_file(const std::string& filename)
+        {
+            reset();
+            filename_ = filename;
+
+            auto stream = std::make_unique<std::ifstream>(std::filesystem::path(filename), std::ios::binary | std::ios::ate);
+            if (!*stream)
+            {
+                throw std::runtime_error("couldn't open file");
+            }
+            auto size = static_cast<mz_uint64>(stream->tellg());
+
+            archive_->m_pRead = &detail::read_callback;
+            archive_->m_pIO_opaque = stream.get();
+
+            if (!mz_zip_reader_init(archive_.get(), size, 0))
+            {
+                throw std::runtime_error("bad zip");
+            }
+
+            file_stream_ = std::move(stream);
+        }
+
+        bool is_file_backed() const { return file_stream_ != nullptr; }
+
+        // streams the archive being written into <filename>.tmp instead of memory,
+        // save() finalizes it and moves it in place, dropping it removes the temp file
+        void create_file(const std::string& filename)
+        {
+            reset();
+            filename_ = filename;
+
+            auto sink = std::make_unique<detail::file_sink>(filename + ".tmp");
+            if (!sink->stream)
+            {
+                throw std::runtime_error("couldn't open file");
+            }
+
+            archive_->m_pWrite = &detail::file_write_callback;
+            archive_->m_pIO_opaque = sink.get();
+
+            if (!mz_zip_writer_init(archive_.get(), 0))
+            {
+                throw std::runtime_error("bad zip");
+            }
+
+            file_sink_ = std::move(sink);
+        }
+
+        bool is_streaming() const { return file_sink_ != nullptr; }
+
         void save(const std::string& filename)
         {
+            if (file_sink_)
+            {
+                finish_file(filename);
+                return;
+            }
+
             filename_ = filename;
             std::ofstream stream(filename, std::ios::binary);
             save(stream);
@@ -5216,6 +6357,16 @@ namespace miniz_cpp {
 
         void save(std::ostream& stream)
         {
+            if (file_sink_)
+            {
+                finish_file(filename_);
+            }
+
+            if (file_stream_)
+            {
+                start_write();
+            }
+
             if (archive_->m_zip_mode == MZ_ZIP_MODE_WRITING)
             {
                 mz_zip_writer_finalize_archive(archive_.get());
@@ -5237,6 +6388,16 @@ namespace miniz_cpp {
 
         void save(std::vector<unsigned char>& bytes)
         {
+            if (file_sink_)
+            {
+                finish_file(filename_);
+            }
+
+            if (file_stream_)
+            {
+                start_write();
+            }
+
             if (archive_->m_zip_mode == MZ_ZIP_MODE_WRITING)
             {
                 mz_zip_writer_finalize_archive(archive_.get());
@@ -5279,6 +6440,14 @@ namespace miniz_cpp {
                 throw std::runtime_error("");
             }
 
+            file_stream_.reset();
+            if (file_sink_)
+            {
+                auto path = file_sink_->path;
+                file_sink_.reset();
+                std::error_code err;
+                std::filesystem::remove(path, err);
+            }
             buffer_.clear();
             comment.clear();
 
@@ -5375,41 +6544,101 @@ namespace miniz_cpp {
             stream << open(member).rdbuf();
         }
 
-        void extractall(const std::string& path)
-        {
-            extractall(path, infolist());
-        }
-
-        void extractall(const std::string& path, const std::vector<std::string>& members)
+        // inflates the entry straight into a sibling temp file and renames it over path,
+        // so a failed extraction never leaves a truncated file at the destination
+        void extract_to(const std::string& member, const std::filesystem::path& path)
         {
-            for (auto& member : members)
+            if (archive_->m_zip_mode != MZ_ZIP_MODE_READING)
             {
-                extract(member, path);
+                start_read();
             }
-        }
 
-        void extractall(const std::string& path, const std::vector<zip_info>& members)
-        {
-            for (auto& member : members)
+            int index = mz_zip_reader_locate_file(archive_.get(), member.c_str(), nullptr, 0);
+            if (index == -1)
             {
-                extract(member, path);
+                throw std::runtime_error("not found");
             }
+
+            extract_to(static_cast<mz_uint>(index), path);
         }
 
-        void printdir()
+        // zip_info::volume holds the entry index, see getinfo
+        void extract_to(const zip_info& member, const std::filesystem::path& path)
         {
-            printdir(std::cout);
+            extract_to(static_cast<mz_uint>(member.volume), path);
         }
 
-        void printdir(std::ostream& stream)
+        void extract_to(mz_uint index, const std::filesystem::path& path)
         {
-            stream << "  Length " << "  " << "   " << "Date" << "   " << " " << "Time " << "   " << "Name" << std::endl;
-            stream << "---------  ---------- -----   ----" << std::endl;
+            if (archive_->m_zip_mode != MZ_ZIP_MODE_READING)
+            {
+                start_read();
+            }
 
-            std::size_t sum_length = 0;
-            std::size_t file_count = 0;
+            auto temp = path;
+            temp += ".tmp";
 
-            for (auto& member : infolist())
+            std::error_code err;
+            {
+                std::ofstream stream(temp, std::ios::binary | std::ios::trunc);
+                if (!stream)
+                {
+                    throw std::runtime_error("couldn't open file");
+                }
+
+                auto ok = mz_zip_reader_extract_to_callback(archive_.get(), index, &detail::stream_write_callback, &stream, 0);
+                stream.close();
+
+                if (!ok || stream.fail())
+                {
+                    std::filesystem::remove(temp, err);
+                    throw std::runtime_error("file couldn't be extracted");
+                }
+            }
+
+            std::filesystem::rename(temp, path, err);
+            if (err)
+            {
+                std::filesystem::remove(temp, err);
+                throw std::runtime_error("couldn't replace file");
+            }
+        }
+
+        void extractall(const std::string& path)
+        {
+            extractall(path, infolist());
+        }
+
+        void extractall(const std::string& path, const std::vector<std::string>& members)
+        {
+            for (auto& member : members)
+            {
+                extract(member, path);
+            }
+        }
+
+        void extractall(const std::string& path, const std::vector<zip_info>& members)
+        {
+            for (auto& member : members)
+            {
+                extract(member, path);
+            }
+        }
+
+        void printdir()
+        {
+            printdir(std::cout);
+        }
+
+        void printdir(std::ostream& stream)
+        {
+            stream << "  Length " << "  " << "   " << "Date" << "   " << " " << "Time " << "   " << "Name" << std::endl;
+            stream << "---------  ---------- -----   ----" << std::endl;
+
+            std::size_t sum_length = 0;
+            std::size_t file_count = 0;
+
+            for (auto& member : infolist())
             {
                 sum_length += member.file_size;
                 file_count++;
@@ -5514,7 +6743,7 @@ namespace miniz_cpp {
                 start_write();
             }
 
-            if (!mz_zip_writer_add_mem(archive_.get(), arcname.c_str(), bytes.data(), bytes.size(), MZ_BEST_COMPRESSION))
+            if (!mz_zip_writer_add_mem(archive_.get(), arcname.c_str(), bytes.data(), bytes.size(), policy.level_for(arcname, bytes)))
             {
                 throw std::runtime_error("write error");
             }
@@ -5534,21 +6763,101 @@ namespace miniz_cpp {
 
             auto crc = detail::crc32buf(bytes.c_str(), bytes.size());
 
-            if (!mz_zip_writer_add_mem_ex(archive_.get(), info.filename.c_str(), bytes.data(), bytes.size(), info.comment.c_str(), static_cast<mz_uint16>(info.comment.size()), MZ_BEST_COMPRESSION, 0, crc))
+            if (!mz_zip_writer_add_mem_ex(archive_.get(), info.filename.c_str(), bytes.data(), bytes.size(), info.comment.c_str(), static_cast<mz_uint16>(info.comment.size()), policy.level_for(info.filename, bytes), 0, crc))
             {
                 throw std::runtime_error("write error");
             }
         }
 
+        // deflates bytes without touching any archive state, so it can run on any thread.
+        // bytes become the entry's data when they are stored, pass them moved to skip a copy
+        static compressed_entry compress(const std::string& arcname, std::string bytes, int level = MZ_BEST_COMPRESSION)
+        {
+            compressed_entry entry;
+            entry.arcname = arcname;
+            entry.file_size = bytes.size();
+            entry.crc = static_cast<uint32_t>(mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const mz_uint8*>(bytes.data()), bytes.size()));
+
+            // same rule as mz_zip_writer_add_mem_ex, tiny entries are stored
+            if (level != 0 && bytes.size() > 3)
+            {
+                std::size_t size = 0;
+                auto flags = static_cast<int>(tdefl_create_comp_flags_from_zip_params(level, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY));
+                auto data = static_cast<char*>(tdefl_compress_mem_to_heap(bytes.data(), bytes.size(), &size, flags));
+                if (data == nullptr)
+                {
+                    throw std::runtime_error("compress error");
+                }
+                // keep the deflate stream only if it actually saves space
+                if (size < bytes.size())
+                {
+                    entry.data.assign(data, data + size);
+                    entry.deflated = true;
+                }
+                mz_free(data);
+            }
+
+            if (!entry.deflated)
+            {
+                entry.data = std::move(bytes);
+            }
+
+            return entry;
+        }
+
+        void write_compressed(const compressed_entry& entry)
+        {
+            if (archive_->m_zip_mode != MZ_ZIP_MODE_WRITING)
+            {
+                start_write();
+            }
+
+            auto level = entry.deflated ? MZ_BEST_COMPRESSION : MZ_NO_COMPRESSION;
+            if (!mz_zip_writer_add_mem_ex(archive_.get(), entry.arcname.c_str(), entry.data.data(), entry.data.size(), nullptr, 0, static_cast<mz_uint>(level) | MZ_ZIP_FLAG_COMPRESSED_DATA, entry.file_size, entry.crc))
+            {
+                throw std::runtime_error("write error");
+            }
+        }
+
+        // copies a file into the archive as a stored entry a chunk at a time, it is never held whole.
+        // returns its size
+        std::uint64_t write_stored(const std::string& arcname, const std::filesystem::path& path)
+        {
+            if (archive_->m_zip_mode != MZ_ZIP_MODE_WRITING)
+            {
+                start_write();
+            }
+
+            std::ifstream file(path, std::ios::binary);
+            std::error_code err;
+            auto size = std::filesystem::file_size(path, err);
+            if (!file || err)
+            {
+                throw std::runtime_error("couldn't open " + path.string());
+            }
+            if (!mz_zip_writer_add_read_func_stored(archive_.get(), arcname.c_str(), &detail::read_callback, &file, size))
+            {
+                throw std::runtime_error("write error");
+            }
+            return size;
+        }
+
         std::string get_filename() const { return filename_; }
 
         std::string comment;
+        compression_policy policy;
 
     private:
         void start_read()
         {
             if (archive_->m_zip_mode == MZ_ZIP_MODE_READING) return;
 
+            if (file_sink_)
+            {
+                finish_file(filename_);
+                return;
+            }
+
             if (archive_->m_zip_mode == MZ_ZIP_MODE_WRITING)
             {
                 mz_zip_writer_finalize_archive(archive_.get());
@@ -5575,11 +6884,26 @@ namespace miniz_cpp {
             {
                 mz_zip_archive archive_copy;
                 std::memset(&archive_copy, 0, sizeof(mz_zip_archive));
-                std::vector<char> buffer_copy(buffer_.begin(), buffer_.end());
+                std::vector<char> buffer_copy;
 
-                if (!mz_zip_reader_init_mem(&archive_copy, buffer_copy.data(), buffer_copy.size(), 0))
+                if (file_stream_)
                 {
-                    throw std::runtime_error("bad zip");
+                    archive_copy.m_pRead = &detail::read_callback;
+                    archive_copy.m_pIO_opaque = file_stream_.get();
+
+                    if (!mz_zip_reader_init(&archive_copy, archive_->m_archive_size, 0))
+                    {
+                        throw std::runtime_error("bad zip");
+                    }
+                }
+                else
+                {
+                    buffer_copy.assign(buffer_.begin(), buffer_.end());
+
+                    if (!mz_zip_reader_init_mem(&archive_copy, buffer_copy.data(), buffer_copy.size(), 0))
+                    {
+                        throw std::runtime_error("bad zip");
+                    }
                 }
 
                 mz_zip_reader_end(archive_.get());
@@ -5602,6 +6926,7 @@ namespace miniz_cpp {
                 }
 
                 mz_zip_reader_end(&archive_copy);
+                file_stream_.reset();
                 return;
             }
             case MZ_ZIP_MODE_WRITING_HAS_BEEN_FINALIZED:
@@ -5621,6 +6946,33 @@ namespace miniz_cpp {
             }
         }
 
+        void finish_file(const std::string& filename)
+        {
+            if (archive_->m_zip_mode == MZ_ZIP_MODE_WRITING && !mz_zip_writer_finalize_archive(archive_.get()))
+            {
+                throw std::runtime_error("write error");
+            }
+            mz_zip_writer_end(archive_.get());
+
+            auto path = file_sink_->path;
+            file_sink_->stream.close();
+            auto ok = !file_sink_->stream.fail();
+            file_sink_.reset();
+
+            std::error_code err;
+            if (ok)
+            {
+                std::filesystem::rename(path, std::filesystem::path(filename), err);
+            }
+            if (!ok || err)
+            {
+                std::filesystem::remove(path, err);
+                throw std::runtime_error("couldn't write file");
+            }
+
+            load_file(filename);
+        }
+
         void append_comment()
         {
             if (!comment.empty())
@@ -5706,12 +7058,398 @@ namespace miniz_cpp {
 
         std::unique_ptr<mz_zip_archive> archive_;
         std::vector<char> buffer_;
+        std::unique_ptr<std::ifstream> file_stream_;
+        std::unique_ptr<detail::file_sink> file_sink_;
         std::stringstream open_stream_;
         std::string filename_;
     };
 
+    // compresses queued entries on the shared task pool, at most threads at once, and appends them
+    // to the archive from the calling thread in the order they were queued.
+    // compressed entries are held whole in memory until written, queued ones are capped at threads * 2
+    // and at max_bytes of source size together, an entry bigger than max_bytes is queued alone.
+    // stored files are copied in chunks by the calling thread when their turn comes and hold nothing
+    class parallel_writer
+    {
+    public:
+        using loader = std::function<std::string()>;
+        using producer = std::function<compressed_entry(const compression_policy&)>;
+
+        static constexpr std::uint64_t default_max_bytes = 8ull << 20;
+
+        parallel_writer(zip_file& zip, std::size_t threads = 0, tasks::priority priority = tasks::priority::normal,
+            std::uint64_t max_bytes = default_max_bytes)
+            : zip_(zip), policy_(zip.policy), max_in_flight_(0), max_bytes_(max_bytes), tasks_(priority, threads)
+        {
+            if (threads == 0)
+            {
+                threads = tasks::pool::shared().size();
+            }
+            max_in_flight_ = threads * 2;
+        }
+
+        // load runs on a worker thread too, so reading source files overlaps with compression.
+        // bytes is the size load will read, 0 when it isn't known
+        void add(const std::string& arcname, loader load, std::uint64_t bytes = 0)
+        {
+            add_entry([arcname, load = std::move(load)](const compression_policy& policy) {
+                perf::span span("compress", arcname);
+                auto bytes = load();
+                auto level = policy.level_for(arcname, bytes);
+                auto entry = zip_file::compress(arcname, std::move(bytes), level);
+                span.bytes(entry.file_size, entry.data.size());
+                return entry;
+            }, bytes);
+        }
+
+        // make runs on a worker thread and hands back the entry ready to be written, for entries
+        // that don't always need compressing (kept from an earlier run). bytes is the size of its source,
+        // 0 when it isn't known. its exceptions come out of add or finish
+        void add_entry(producer make, std::uint64_t bytes = 0)
+        {
+            // room first, so the entry doesn't start while the queue is already over the budget
+            while (!pending_.empty() && (pending_.size() >= max_in_flight_ || pending_bytes_ + bytes > max_bytes_))
+            {
+                write_next();
+            }
+
+            auto task = std::make_shared<std::packaged_task<compressed_entry()>>([make = std::move(make), this] {
+                return make(policy_);
+            });
+            queued entry;
+            entry.result = task->get_future();
+            entry.bytes = bytes;
+            pending_.push_back(std::move(entry));
+            pending_bytes_ += bytes;
+            tasks_.run([task] { (*task)(); });
+        }
+
+        // stores path as is under arcname, for files the policy wouldn't deflate. written gets its size
+        // once it is in, on the calling thread
+        void add_stored(const std::string& arcname, const std::filesystem::path& path, std::function<void(std::uint64_t)> written = nullptr)
+        {
+            while (pending_.size() >= max_in_flight_)
+            {
+                write_next();
+            }
+
+            queued entry;
+            entry.arcname = arcname;
+            entry.stored = path;
+            entry.written = std::move(written);
+            pending_.push_back(std::move(entry));
+        }
+
+        void finish()
+        {
+            while (!pending_.empty())
+            {
+                write_next();
+            }
+        }
+
+    private:
+        // compresses entries that didn't start yet while the next one isn't done, so a writer on a
+        // pool worker doesn't wait for workers that are all busy
+        void write_next()
+        {
+            auto next = std::move(pending_.front());
+            pending_.pop_front();
+            pending_bytes_ -= next.bytes;
+            if (!next.stored.empty())
+            {
+                perf::span span("store", next.arcname);
+                auto size = zip_.write_stored(next.arcname, next.stored);
+                span.bytes(size, size);
+                if (next.written) next.written(size);
+                return;
+            }
+            while (next.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready && tasks_.run_one())
+            {
+            }
+            zip_.write_compressed(next.result.get());
+        }
+
+        // a compressed entry on its way, or a file stored when its turn comes
+        struct queued
+        {
+            std::future<compressed_entry> result;
+            std::uint64_t bytes = 0;
+            std::string arcname;
+            std::filesystem::path stored;
+            std::function<void(std::uint64_t)> written;
+        };
+
+        zip_file& zip_;
+        compression_policy policy_;
+        std::size_t max_in_flight_;
+        std::uint64_t max_bytes_;
+        std::uint64_t pending_bytes_ = 0;
+        std::deque<queued> pending_;
+        // last, its destructor waits for queued entries that still use the members above
+        tasks::group tasks_;
+    };
+
+    // remembers the crc-32 of files on disk along with their size and mtime, so extraction can tell
+    // a file that already matches an entry's central directory record without reading it again.
+    // kept as "crc size:mtime path" lines, a cache without a path lives in memory only
+    class extract_cache
+    {
+    public:
+        static std::shared_ptr<extract_cache> load(const std::filesystem::path& path)
+        {
+            auto cache = std::make_shared<extract_cache>();
+            cache->path_ = path;
+
+            std::ifstream file(path);
+            std::string line;
+            while (std::getline(file, line))
+            {
+                auto first = line.find(' ');
+                auto second = first == std::string::npos ? first : line.find(' ', first + 1);
+                if (second == std::string::npos || second + 1 >= line.size()) continue;
+
+                char* end = nullptr;
+                auto crc = std::strtoul(line.c_str(), &end, 16);
+                if (end != line.c_str() + first) continue;
+                cache->entries_[line.substr(second + 1)] = { line.substr(first + 1, second - first - 1), static_cast<std::uint32_t>(crc) };
+            }
+            return cache;
+        }
+
+        const std::filesystem::path& path() const { return path_; }
+
+        void save()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!dirty_ || path_.empty()) return;
+
+            auto part = std::filesystem::path(path_).concat(".part");
+            {
+                std::ofstream file(part, std::ios::binary | std::ios::trunc);
+                char crc[9];
+                for (const auto& entry : entries_)
+                {
+                    std::snprintf(crc, sizeof(crc), "%08x", entry.second.second);
+                    file << crc << ' ' << entry.second.first << ' ' << entry.first << '\n';
+                }
+                if (!file.flush()) throw std::runtime_error("couldn't write " + part.string());
+            }
+            std::filesystem::rename(part, path_);
+            dirty_ = false;
+        }
+
+        // size is checked first, crc comes from the cache while size and mtime still match it
+        bool unchanged(const std::filesystem::path& path, const zip_info& info)
+        {
+            std::error_code err;
+            if (std::filesystem::file_size(path, err) != info.file_size || err) return false;
+
+            auto current = stamp(path);
+            if (current.empty()) return false;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto found = entries_.find(key(path));
+                if (found != entries_.end() && found->second.first == current) return found->second.second == info.crc;
+            }
+
+            std::uint32_t crc;
+            if (!crc_of_file(path, crc)) return false;
+            record(path, crc);
+            return crc == info.crc;
+        }
+
+        void record(const std::filesystem::path& path, std::uint32_t crc)
+        {
+            auto current = stamp(path);
+            auto name = key(path);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (current.empty() || name.find('\n') != std::string::npos) entries_.erase(name);
+            else entries_[name] = { current, crc };
+            dirty_ = true;
+        }
+
+        static bool crc_of_file(const std::filesystem::path& path, std::uint32_t& crc)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file) return false;
+
+            std::vector<char> block(1 << 20);
+            mz_ulong value = MZ_CRC32_INIT;
+            while (file)
+            {
+                file.read(block.data(), static_cast<std::streamsize>(block.size()));
+                value = mz_crc32(value, reinterpret_cast<const mz_uint8*>(block.data()), static_cast<std::size_t>(file.gcount()));
+            }
+            if (file.bad()) return false;
+            crc = static_cast<std::uint32_t>(value);
+            return true;
+        }
+
+    private:
+        static std::string key(const std::filesystem::path& path)
+        {
+            return path.lexically_normal().generic_string();
+        }
+
+        static std::string stamp(const std::filesystem::path& path)
+        {
+            std::error_code size_err, time_err;
+            auto size = std::filesystem::file_size(path, size_err);
+            auto mtime = std::filesystem::last_write_time(path, time_err).time_since_epoch().count();
+            if (size_err || time_err) return "";
+            return std::to_string(size) + ":" + std::to_string(mtime);
+        }
+
+        std::filesystem::path path_;
+        std::unordered_map<std::string, std::pair<std::string, std::uint32_t>> entries_;
+        std::mutex mutex_;
+        bool dirty_ = false;
+    };
+
+    using extract_job = std::pair<zip_info, std::filesystem::path>;
+    using extract_progress = std::function<void(std::size_t done, std::size_t total)>;
+
+    // extracts jobs on the shared task pool, threads at most, each holding its own reader over the archive
+    // file. falls back to the given reader for in-memory archives or a single thread.
+    // progress is called from the worker threads. returns how many files were written,
+    // files the cache finds unchanged are left as they are
+    inline std::size_t extract_entries(zip_file& zip, std::vector<extract_job> jobs, extract_progress progress = nullptr,
+        std::size_t threads = 0, extract_cache* cache = nullptr)
+    {
+        perf::trace::scope trace("extract_entries", zip.get_filename());
+        for (const auto& job : jobs)
+        {
+            std::filesystem::create_directories(job.second.parent_path());
+        }
+
+        // biggest entries first so one large .geode doesn't end up last on a single thread
+        std::stable_sort(jobs.begin(), jobs.end(), [](const extract_job& a, const extract_job& b) {
+            return a.first.compress_size > b.first.compress_size;
+        });
+
+        if (threads == 0) threads = tasks::pool::shared().size() + 1;
+        threads = std::min(threads, jobs.size());
+
+        std::atomic_size_t next(0);
+        std::atomic_size_t done(0);
+        std::atomic_size_t written(0);
+        std::atomic_bool failed(false);
+        std::mutex error_mutex;
+        std::string error;
+
+        auto work = [&](zip_file& reader) {
+            for (auto i = next++; i < jobs.size() && !failed; i = next++)
+            {
+                try
+                {
+                    const auto& job = jobs[i];
+                    perf::span span("extract", job.first.filename);
+                    if (!cache || !cache->unchanged(job.second, job.first))
+                    {
+                        span.bytes(job.first.compress_size, job.first.file_size);
+                        reader.extract_to(job.first, job.second);
+                        if (cache) cache->record(job.second, job.first.crc);
+                        written++;
+                    }
+                    else
+                    {
+                        // nothing inflated or written, throughput of extract stays what was actually extracted
+                        span.rename("extract.unchanged");
+                    }
+                }
+                catch (const std::exception& e)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!failed.exchange(true)) error = jobs[i].first.filename + ": " + e.what();
+                    return;
+                }
+                if (progress) progress(++done, jobs.size());
+            }
+        };
+
+        if (threads <= 1 || !zip.is_file_backed())
+        {
+            work(zip);
+        }
+        else
+        {
+            // the calling thread takes one of the readers itself when it gets to wait
+            tasks::group workers(tasks::priority::normal, threads);
+            for (std::size_t i = 0; i < threads; i++)
+            {
+                workers.run([&] {
+                    try
+                    {
+                        zip_file reader;
+                        reader.load_file(zip.get_filename());
+                        work(reader);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        std::lock_guard<std::mutex> lock(error_mutex);
+                        if (!failed.exchange(true)) error = e.what();
+                    }
+                });
+            }
+            workers.wait();
+        }
+
+        if (failed) throw std::runtime_error(error);
+        return written;
+    }
+
+    // routes map an entry name prefix (like "mods/") to a destination dir
+    using extract_routes = std::vector<std::pair<std::string, std::filesystem::path>>;
+
+    // destination of a '/' separated entry name by the first route it starts with. empty for dirs,
+    // names matching no route and names that would land outside of their route's dir (unsafe is set then)
+    inline std::filesystem::path route_entry(const std::string& name, const extract_routes& routes, bool* unsafe = nullptr)
+    {
+        if (unsafe) *unsafe = false;
+        if (name.empty() || name.back() == '/') return {};
+
+        for (const auto& route : routes)
+        {
+            if (name.compare(0, route.first.size(), route.first) != 0) continue;
+
+            auto rel = std::filesystem::path(name.substr(route.first.size())).lexically_normal();
+            // "mods//Windows/x" leaves "/Windows/x", on windows that's not absolute but still lands on the drive's root
+            if (rel.empty() || rel.is_absolute() || rel.has_root_name() || rel.has_root_directory() || rel.begin()->string() == "..")
+            {
+                if (unsafe) *unsafe = true;
+                return {};
+            }
+            return route.second / rel;
+        }
+        return {};
+    }
+
+    // jobs for the routed entries, except the ones skip returns true for (it gets the '/' separated name).
+    // names of unsafe entries are collected if asked to
+    inline std::vector<extract_job> route_entries(const std::vector<zip_info>& entries, const extract_routes& routes,
+        const std::function<bool(const std::string&)>& skip = nullptr, std::vector<std::string>* unsafe_entries = nullptr)
+    {
+        std::vector<extract_job> jobs;
+        for (const auto& info : entries)
+        {
+            auto name = info.filename;
+            std::replace(name.begin(), name.end(), '\\', '/');
+            if (skip && skip(name)) continue;
+
+            bool unsafe = false;
+            auto path = route_entry(name, routes, &unsafe);
+            if (unsafe && unsafe_entries) unsafe_entries->push_back(info.filename);
+            if (!path.empty()) jobs.emplace_back(info, path);
+        }
+        return jobs;
+    }
+
 } // namespace miniz_cpp
 
+// everything above builds without Geode, MINIZ_CPP_NO_GEODE leaves out the cocos wrapper below
+#ifndef MINIZ_CPP_NO_GEODE
+
 #include <Geode/Geode.hpp>
 
 namespace geode::utils::file {
@@ -5719,8 +7457,17 @@ namespace geode::utils::file {
     class CCMiniZFile : public cocos2d::CCObject {
     protected:
         std::unique_ptr<miniz_cpp::zip_file> m_zip;
+        std::unique_ptr<miniz_cpp::parallel_writer> m_writer;
+        std::shared_ptr<miniz_cpp::extract_cache> m_extractCache;
         std::string m_path;
         bool m_isDirty = false;
+        bool m_readOnly = false;
+
+        static uint64_t fileSize(const std::string& path) {
+            std::error_code error;
+            auto size = std::filesystem::file_size(path, error);
+            return error ? 0 : size;
+        }
 
     public:
         static Result<CCMiniZFile*> create(const std::string& path) {
@@ -5750,9 +7497,70 @@ namespace geode::utils::file {
             }
         }
 
+        // read-only mode keeps the archive on disk and reads only the central directory
+        // plus the entries that are actually requested
+        static Result<CCMiniZFile*> createReadOnly(const std::string& path) {
+            auto inst = new CCMiniZFile();
+            if (!inst->initWithPathReadOnly(path)) {
+                delete inst;
+                return Err("Failed to open zip file: " + path);
+            }
+            inst->autorelease();
+            return Ok(inst);
+        }
+
+        bool initWithPathReadOnly(const std::string& path) {
+            m_path = path;
+            m_readOnly = true;
+            try {
+                m_zip = std::make_unique<miniz_cpp::zip_file>();
+                m_zip->load_file(path);
+                return true;
+            }
+            catch (const std::exception& e) {
+                log::warn("miniz init error: {}", e.what());
+                return false;
+            }
+        }
+
+        // streaming mode writes compressed entries straight to disk as they are added,
+        // so the archive is never held in memory; save() finalizes it in place
+        static Result<CCMiniZFile*> createStreaming(const std::string& path) {
+            auto inst = new CCMiniZFile();
+            if (!inst->initWithPathStreaming(path)) {
+                delete inst;
+                return Err("Failed to create zip file: " + path);
+            }
+            inst->autorelease();
+            return Ok(inst);
+        }
+
+        bool initWithPathStreaming(const std::string& path) {
+            m_path = path;
+            try {
+                m_zip = std::make_unique<miniz_cpp::zip_file>();
+                m_zip->create_file(path);
+                return true;
+            }
+            catch (const std::exception& e) {
+                log::warn("miniz init error: {}", e.what());
+                return false;
+            }
+        }
+
         const std::string& getPath() const { return m_path; }
+        bool isReadOnly() const { return m_readOnly; }
+
+        // per content class compression levels, applies to entries written after the call
+        void setCompressionPolicy(const miniz_cpp::compression_policy& policy) { m_zip->policy = policy; }
+        const miniz_cpp::compression_policy& getCompressionPolicy() const { return m_zip->policy; }
         const std::unique_ptr<miniz_cpp::zip_file>& getZipFile() const { return m_zip; }
 
+        // with a cache set, extraction leaves files alone when their size and crc-32 already match
+        // the entry, and records the crc of every file it writes
+        void setExtractCache(std::shared_ptr<miniz_cpp::extract_cache> cache) { m_extractCache = std::move(cache); }
+        const std::shared_ptr<miniz_cpp::extract_cache>& getExtractCache() const { return m_extractCache; }
+
         bool hasFile(const std::string& name) const {
             try {
                 return m_zip->has_file(name);
@@ -5767,7 +7575,10 @@ namespace geode::utils::file {
                 if (!m_zip->has_file(name)) {
                     return Err("File not found in archive: " + name);
                 }
-                return Ok(m_zip->read(name));
+                perf::span span("zip.read", name);
+                auto data = m_zip->read(name);
+                span.bytes_out(data.size());
+                return Ok(data);
             }
             catch (const std::exception& e) {
                 return Err("Failed to read file from zip: " + std::string(e.what()));
@@ -5779,7 +7590,9 @@ namespace geode::utils::file {
                 if (!m_zip->has_file(name)) {
                     return Err("File not found in archive: " + name);
                 }
+                perf::span span("zip.read", name);
                 std::string strData = m_zip->read(name);
+                span.bytes_out(strData.size());
                 return Ok(std::vector<uint8_t>(strData.begin(), strData.end()));
             }
             catch (const std::exception& e) {
@@ -5793,7 +7606,9 @@ namespace geode::utils::file {
             return Ok(cocos2d::CCString::createWithData((const unsigned char*)data.data(), data.size()));
         }
 
-        Result<cocos2d::CCTexture2D*> readAsCCTexture(const std::string& name) const {
+        // reads and decodes without making a texture, so it can run off the main thread while nothing
+        // else uses this file. the image isn't autoreleased, it's the caller's to release
+        Result<cocos2d::CCImage*> readAsCCImage(const std::string& name) const {
             GEODE_UNWRAP_INTO(auto data, readBinary(name));
 
             cocos2d::CCImage* image = new cocos2d::CCImage();
@@ -5802,6 +7617,12 @@ namespace geode::utils::file {
                 image->release();
                 return Err("Failed to create CCImage from data: " + name);
             }
+            return Ok(image);
+        }
+
+        // main thread only, textures are made on the gl context
+        Result<cocos2d::CCTexture2D*> readAsCCTexture(const std::string& name) const {
+            GEODE_UNWRAP_INTO(auto image, readAsCCImage(name));
 
             cocos2d::CCTexture2D* texture = new cocos2d::CCTexture2D();
             if (!texture->initWithImage(image)) {
@@ -5810,6 +7631,7 @@ namespace geode::utils::file {
                 return Err("Failed to create CCTexture2D from CCImage: " + name);
             }
 
+            image->release();
             texture->autorelease();
             return Ok(texture);
         }
@@ -5823,6 +7645,15 @@ namespace geode::utils::file {
             }
         }
 
+        Result<std::vector<miniz_cpp::zip_info>> listEntries() const {
+            try {
+                return Ok(m_zip->infolist());
+            }
+            catch (const std::exception& e) {
+                return Err("Failed to list zip contents: " + std::string(e.what()));
+            }
+        }
+
         Result<cocos2d::CCArray*> listFilesCCArray() const {
             std::vector<std::string> list;
             GEODE_UNWRAP_INTO(list, listFiles());
@@ -5834,7 +7665,11 @@ namespace geode::utils::file {
         }
 
         Result<> write(const std::string& name, const std::string& data) {
+            if (m_readOnly) return Err("Archive is opened read-only: " + m_path);
+            GEODE_UNWRAP(flushWrites());
             try {
+                perf::span span("zip.write", name);
+                span.bytes_in(data.size());
                 m_zip->writestr(name, data);
                 m_isDirty = true;
                 return Ok();
@@ -5845,7 +7680,11 @@ namespace geode::utils::file {
         }
 
         Result<> write(const std::string& name, const std::vector<uint8_t>& data) {
+            if (m_readOnly) return Err("Archive is opened read-only: " + m_path);
+            GEODE_UNWRAP(flushWrites());
             try {
+                perf::span span("zip.write", name);
+                span.bytes_in(data.size());
                 m_zip->writestr(name, std::string(data.begin(), data.end()));
                 m_isDirty = true;
                 return Ok();
@@ -5855,7 +7694,41 @@ namespace geode::utils::file {
             }
         }
 
+        // queued entries are loaded and compressed on worker threads, then written
+        // in queue order; data is loaded lazily so sources aren't all held in memory
+        Result<> queueWrite(const std::string& name, std::function<std::vector<uint8_t>()> load) {
+            if (m_readOnly) return Err("Archive is opened read-only: " + m_path);
+            try {
+                if (!m_writer) m_writer = std::make_unique<miniz_cpp::parallel_writer>(*m_zip);
+                m_writer->add(name, [load = std::move(load)] {
+                    auto data = load();
+                    return std::string(data.begin(), data.end());
+                });
+                m_isDirty = true;
+                return Ok();
+            }
+            catch (const std::exception& e) {
+                m_writer.reset();
+                return Err("Failed to write file to zip: " + std::string(e.what()));
+            }
+        }
+
+        Result<> flushWrites() {
+            if (!m_writer) return Ok();
+            try {
+                m_writer->finish();
+                m_writer.reset();
+                return Ok();
+            }
+            catch (const std::exception& e) {
+                m_writer.reset();
+                return Err("Failed to write file to zip: " + std::string(e.what()));
+            }
+        }
+
         Result<> removeFile(const std::string& name) {
+            if (m_readOnly) return Err("Archive is opened read-only: " + m_path);
+            GEODE_UNWRAP(flushWrites());
             try {
                 if (!m_zip->has_file(name)) {
                     return Err("File not found in archive: " + name);
@@ -5863,6 +7736,7 @@ namespace geode::utils::file {
 
                 auto oldZip = std::move(m_zip);
                 m_zip = std::make_unique<miniz_cpp::zip_file>();
+                m_zip->policy = oldZip->policy;
 
                 for (const auto& fname : oldZip->namelist()) {
                     if (fname == name) continue;
@@ -5878,11 +7752,14 @@ namespace geode::utils::file {
         }
 
         Result<> removeFiles(const std::vector<std::string>& names) {
+            if (m_readOnly) return Err("Archive is opened read-only: " + m_path);
+            GEODE_UNWRAP(flushWrites());
             try {
                 std::unordered_set<std::string> nameSet(names.begin(), names.end());
 
                 auto oldZip = std::move(m_zip);
                 m_zip = std::make_unique<miniz_cpp::zip_file>();
+                m_zip->policy = oldZip->policy;
 
                 for (const auto& fname : oldZip->namelist()) {
                     if (nameSet.count(fname) == 0) {
@@ -5899,8 +7776,12 @@ namespace geode::utils::file {
         }
 
         Result<> clear() {
+            if (m_readOnly) return Err("Archive is opened read-only: " + m_path);
+            m_writer.reset();
             try {
+                auto policy = m_zip->policy;
                 m_zip = std::make_unique<miniz_cpp::zip_file>();
+                m_zip->policy = policy;
                 m_isDirty = true;
                 return Ok();
             }
@@ -5914,11 +7795,7 @@ namespace geode::utils::file {
                 if (!m_zip->has_file(name)) {
                     return Err("File not found in archive: " + name);
                 }
-                std::string data = m_zip->read(name);
-                std::ofstream out(outputPath, std::ios::binary);
-                if (!out) return Err("Failed to open output file: " + outputPath);
-                out.write(data.data(), data.size());
-                out.close();
+                m_zip->extract_to(name, outputPath);
                 return Ok();
             }
             catch (const std::exception& e) {
@@ -5926,23 +7803,50 @@ namespace geode::utils::file {
             }
         }
 
-        Result<> extractAll(const std::string& outputDir) const {
-            std::vector<std::string> files;
-            GEODE_UNWRAP_INTO(files, listFiles());
+        using ExtractProgress = miniz_cpp::extract_progress;
+        using ExtractJobs = std::vector<miniz_cpp::extract_job>;
 
-            for (const auto& name : files) {
-                auto outputPath = std::filesystem::path(outputDir) / name;
-                std::filesystem::create_directories(outputPath.parent_path());
-                GEODE_UNWRAP(extractFile(name, outputPath.string()));
+        // extracts entries on a pool of threads, see miniz_cpp::extract_entries
+        Result<> extractEntries(ExtractJobs jobs, ExtractProgress progress = nullptr, size_t threads = 0) const {
+            try {
+                miniz_cpp::extract_entries(*m_zip, std::move(jobs), std::move(progress), threads, m_extractCache.get());
+                return Ok();
             }
+            catch (const std::exception& e) {
+                return Err("Failed to extract file: " + std::string(e.what()));
+            }
+        }
 
-            return Ok();
+        // entries that would land outside of outputDir ("../x", absolute names) are skipped and logged
+        Result<> extractAll(const std::string& outputDir, ExtractProgress progress = nullptr, size_t threads = 0) const {
+            return extractRouted({ { "", outputDir } }, std::move(progress), threads);
+        }
+
+        // extracts entries straight to where they belong. routes map an entry name prefix
+        // (like "mods/") to a destination dir, entries matching no route are skipped,
+        // as are the ones skip returns true for (it gets the '/' separated entry name)
+        Result<> extractRouted(
+            const std::vector<std::pair<std::string, std::filesystem::path>>& routes,
+            ExtractProgress progress = nullptr, size_t threads = 0,
+            std::function<bool(const std::string&)> skip = nullptr
+        ) const {
+            std::vector<miniz_cpp::zip_info> entries;
+            GEODE_UNWRAP_INTO(entries, listEntries());
+
+            std::vector<std::string> unsafe;
+            auto jobs = miniz_cpp::route_entries(entries, routes, skip, &unsafe);
+            for (const auto& name : unsafe) log::warn("skipping unsafe entry {}", name);
+
+            return extractEntries(std::move(jobs), std::move(progress), threads);
         }
 
         Result<> save() {
+            GEODE_UNWRAP(flushWrites());
             if (!m_isDirty) return Ok();
             try {
+                perf::span span("zip.save", m_path);
                 m_zip->save(m_path);
+                span.bytes_out(fileSize(m_path));
                 m_isDirty = false;
                 return Ok();
             }
@@ -5952,8 +7856,11 @@ namespace geode::utils::file {
         }
 
         Result<> saveAs(const std::string& newPath) {
+            GEODE_UNWRAP(flushWrites());
             try {
+                perf::span span("zip.save", newPath);
                 m_zip->save(newPath);
+                span.bytes_out(fileSize(newPath));
                 return Ok();
             }
             catch (const std::exception& e) {
@@ -6030,4 +7937,6 @@ namespace geode::utils::file {
         popup->show();
     }
 
-} // namespace geode::utils::file
\ No newline at end of file
+} // namespace geode::utils::file
+
+#endif // MINIZ_CPP_NO_GEODE
\ No newline at end of file